@@ -0,0 +1,13 @@
+#ifndef ASS4_H
+#define ASS4_H
+
+// Size of the board, which may be given by the build (for example -DSIZE=6)
+#ifndef SIZE
+#define SIZE 8
+#endif
+
+void createBoard(char board[][SIZE], char fen[]);
+void printBoard(char board[][SIZE]);
+int makeMove(char board[][SIZE], char pgn[], int isWhiteTurn);
+
+#endif
@@ -1,50 +1,13 @@
+// chess-game.h comes first, so its POSIX feature macro is defined before any system header
+#include "chess-game.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
 #include <assert.h>
-
-#include "ass4.h"
-
-
-typedef struct {
-	char srcPiece, srcRow, srcCol, destPiece, destRow, destCol, promotionPiece;
-	int iSrc, jSrc, iDest, jDest;
-	int isWhite, isCapture, isPromotion, isCheck, isMate, isLegal;
-} Move;
-
-// Functions Declarations
-void printColumns();
-void printSpacers();
-void printRow(char row[], int rowIdx);
-void createRow(char fenString[], char boardRow[]);
-char convertPieceChar(Move move);
-Move initMove(char board[][SIZE], char pgn[], int isWhiteTurn);
-Move parseSrcFromPgn(char pgn[], Move move);
-Move parseDestFromPgn(char pgn[], Move move);
-Move convertSrcMatrixIndex(Move move);
-Move convertDestMatrixIndex(Move move);
-Move parseConditionFromPgn(char pgn[], Move move);
-char findDestPiece(int iDest, int jDest, char board[][SIZE]);
-Move findOptionalPieceByMove(char board[][SIZE], Move move);
-Move checkRookMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-Move checkKnightMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-Move checkBishopMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-Move checkQueenMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-Move checkKingMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-Move checkPawnMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc);
-int isWhiteDest(char destPiece);
-int sameColorPieceTest(char destPiece, int isWhite);
-int noCaptureDestTest(int isCapture, char destPiece);
-int noCaptureDeclareTest(char destPiece, int isWhite, int isCapture);
-Move testCheckConditions(char board[][SIZE], Move move);
-int isCheckCase(char board[][SIZE], int isWhiteMove, int isTheratToWhite);
-int testBoardCheck(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite);
-int checkTrialWithoutDeclare(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite);
-int checkDeclareWithoutTrial(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite);
-int moveCauseToCheckThreat(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite);
-int limitedMoveInCheckCase(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite);
+#include <time.h>
 
 
 // Chess characters and PGN signs
@@ -60,12 +23,246 @@ const char CHECK = '+';
 const char MATE = '#';
 const char FIRST_COL = 'a';
 
-// FEN separator for strtok()
+// FEN rows separator and castling rights chars according to castling right bit
 const char SEP[] = "/";
+const char CASTLING_CHARS[] = "KQkq";
 
 // Board characters
 const char EMPTY = ' ';
 
+// Pieces chars according to piece type index
+const char PIECE_CHARS[] = "PNBRQK";
+
+// Pieces values in centipawns according to piece type index, King can't be captured
+const int PIECE_VALUES[PIECE_TYPES] = { 100, 320, 330, 500, 900, 0 };
+
+/*
+	Tapered evaluation: pieces values in middlegame and in endgame, and the phase weight of any
+	piece type. the phase of position is the sum of weights of its pieces (at most TOTAL_PHASE),
+	and its score is the average of the middlegame and endgame scores by the phase.
+*/
+#define TOTAL_PHASE 24
+const int MIDDLEGAME_VALUES[PIECE_TYPES] = { 82, 337, 365, 477, 1025, 0 };
+const int ENDGAME_VALUES[PIECE_TYPES] = { 94, 281, 297, 512, 936, 0 };
+const int PHASE_WEIGHTS[PIECE_TYPES] = { 0, 1, 1, 2, 4, 0 };
+
+/*
+	Piece-square bonuses of white pieces on 8x8 board, from the top row (row 8) as in 2D array
+	board. black pieces use the mirrored row, and board in other SIZE is scaled to these tables.
+	the middlegame tables hold any piece type, and Pawn and King have other tables in endgame -
+	advanced Pawn and central King. any other piece has the same bonuses in both phases.
+*/
+const signed char MIDDLEGAME_SQUARES[PIECE_TYPES][64] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 50, 50, 50, 50, 50, 50, 50, 50, 10, 10, 20, 30, 30, 20, 10, 10, 5, 5, 10, 25, 25, 10, 5, 5,
+	  0, 0, 0, 20, 20, 0, 0, 0, 5, -5, -10, 0, 0, -10, -5, 5, 5, 10, 10, -20, -20, 10, 10, 5, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ -50, -40, -30, -30, -30, -30, -40, -50, -40, -20, 0, 0, 0, 0, -20, -40, -30, 0, 10, 15, 15, 10, 0, -30,
+	  -30, 5, 15, 20, 20, 15, 5, -30, -30, 0, 15, 20, 20, 15, 0, -30, -30, 5, 10, 15, 15, 10, 5, -30,
+	  -40, -20, 0, 5, 5, 0, -20, -40, -50, -40, -30, -30, -30, -30, -40, -50 },
+	{ -20, -10, -10, -10, -10, -10, -10, -20, -10, 0, 0, 0, 0, 0, 0, -10, -10, 0, 5, 10, 10, 5, 0, -10,
+	  -10, 5, 5, 10, 10, 5, 5, -10, -10, 0, 10, 10, 10, 10, 0, -10, -10, 10, 10, 10, 10, 10, 10, -10,
+	  -10, 5, 0, 0, 0, 0, 5, -10, -20, -10, -10, -10, -10, -10, -10, -20 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 5, 10, 10, 10, 10, 10, 10, 5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5,
+	  -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, 0, 0, 0, 5, 5, 0, 0, 0 },
+	{ -20, -10, -10, -5, -5, -10, -10, -20, -10, 0, 0, 0, 0, 0, 0, -10, -10, 0, 5, 5, 5, 5, 0, -10,
+	  -5, 0, 5, 5, 5, 5, 0, -5, 0, 0, 5, 5, 5, 5, 0, -5, -10, 5, 5, 5, 5, 5, 0, -10,
+	  -10, 0, 5, 0, 0, 0, 0, -10, -20, -10, -10, -5, -5, -10, -10, -20 },
+	{ -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30,
+	  -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30,
+	  -20, -30, -30, -40, -40, -30, -30, -20, -10, -20, -20, -20, -20, -20, -20, -10,
+	  20, 20, 0, 0, 0, 0, 20, 20, 20, 30, 10, 0, 0, 10, 30, 20 }
+};
+const signed char ENDGAME_PAWN_SQUARES[64] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 80, 80, 80, 80, 80, 80, 80, 80, 50, 50, 50, 50, 50, 50, 50, 50, 30, 30, 30, 30, 30, 30, 30, 30,
+	15, 15, 15, 15, 15, 15, 15, 15, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+const signed char ENDGAME_KING_SQUARES[64] = {
+	-50, -40, -30, -20, -20, -30, -40, -50, -30, -20, -10, 0, 0, -10, -20, -30, -30, -10, 20, 30, 30, 20, -10, -30,
+	-30, -10, 30, 40, 40, 30, -10, -30, -30, -10, 30, 40, 40, 30, -10, -30, -30, -10, 20, 30, 30, 20, -10, -30,
+	-30, -30, 0, 0, 0, 0, -30, -30, -50, -30, -30, -30, -30, -30, -30, -50
+};
+
+// Initial position of standard game, for PGN game without FEN tag
+const char START_FEN[] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+/*
+	Attack tables of pieces which move one step.
+	The tables are generated at compile time for the given SIZE: STEP_BIT() is constant expression
+	which returns the bit of the square in (row, column) offsets from square s, or 0 if the step is
+	beyond the scope of board. SQUARES_TABLE() expands any macro for all 64 possible squares, and
+	the squares beyond SQUARES hold no attacks.
+*/
+#define STEP_BIT(s, di, dj) (((s) < SQUARES && (s) / SIZE + (di) >= 0 && (s) / SIZE + (di) < SIZE \
+	&& (s) % SIZE + (dj) >= 0 && (s) % SIZE + (dj) < SIZE) ? 1ULL << (((s) + (di) * SIZE + (dj)) & 63) : 0ULL)
+
+#define KNIGHT_ATTACKS_OF(s) (STEP_BIT(s, -2, -1) | STEP_BIT(s, -2, 1) | STEP_BIT(s, -1, -2) | STEP_BIT(s, -1, 2) \
+	| STEP_BIT(s, 1, -2) | STEP_BIT(s, 1, 2) | STEP_BIT(s, 2, -1) | STEP_BIT(s, 2, 1))
+#define KING_ATTACKS_OF(s) (STEP_BIT(s, -1, -1) | STEP_BIT(s, -1, 0) | STEP_BIT(s, -1, 1) | STEP_BIT(s, 0, -1) \
+	| STEP_BIT(s, 0, 1) | STEP_BIT(s, 1, -1) | STEP_BIT(s, 1, 0) | STEP_BIT(s, 1, 1))
+#define WHITE_PAWN_ATTACKS_OF(s) (STEP_BIT(s, -1, -1) | STEP_BIT(s, -1, 1))
+#define BLACK_PAWN_ATTACKS_OF(s) (STEP_BIT(s, 1, -1) | STEP_BIT(s, 1, 1))
+#define WHITE_PAWN_PUSHES_OF(s) STEP_BIT(s, -1, 0)
+#define BLACK_PAWN_PUSHES_OF(s) STEP_BIT(s, 1, 0)
+
+#define SQUARES_TABLE(M) \
+	M(0), M(1), M(2), M(3), M(4), M(5), M(6), M(7), M(8), M(9), M(10), M(11), M(12), M(13), M(14), M(15), \
+	M(16), M(17), M(18), M(19), M(20), M(21), M(22), M(23), M(24), M(25), M(26), M(27), M(28), M(29), M(30), M(31), \
+	M(32), M(33), M(34), M(35), M(36), M(37), M(38), M(39), M(40), M(41), M(42), M(43), M(44), M(45), M(46), M(47), \
+	M(48), M(49), M(50), M(51), M(52), M(53), M(54), M(55), M(56), M(57), M(58), M(59), M(60), M(61), M(62), M(63)
+
+const Bitboard KNIGHT_ATTACKS[64] = { SQUARES_TABLE(KNIGHT_ATTACKS_OF) };
+const Bitboard KING_ATTACKS[64] = { SQUARES_TABLE(KING_ATTACKS_OF) };
+const Bitboard PAWN_ATTACKS[COLORS][64] = { { SQUARES_TABLE(WHITE_PAWN_ATTACKS_OF) }, { SQUARES_TABLE(BLACK_PAWN_ATTACKS_OF) } };
+const Bitboard PAWN_PUSHES[COLORS][64] = { { SQUARES_TABLE(WHITE_PAWN_PUSHES_OF) }, { SQUARES_TABLE(BLACK_PAWN_PUSHES_OF) } };
+
+/*
+	Magics which were found by initSlidingTables() for the standard 8x8 board. they are tried
+	first, so the tables are initialized without search. any other SIZE finds its magics at runtime.
+*/
+#if SIZE == 8
+const Bitboard ROOK_MAGICS[64] = {
+	0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+	0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+	0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+	0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+	0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+	0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+	0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+	0x0050500500080100ULL, 0x0000020080040080ULL, 0x0C10010400420810ULL, 0x1040008200005104ULL,
+	0x01808240088004A0ULL, 0x0882804004802000ULL, 0x0880402001001100ULL, 0x2000210409001000ULL,
+	0x2000480131001500ULL, 0x0000800400800200ULL, 0x000002380C001003ULL, 0x4600084882000431ULL,
+	0x0080002000504000ULL, 0x0300500020004002ULL, 0x0040408200220011ULL, 0x0010040008004040ULL,
+	0x0000080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+	0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+	0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+	0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+	0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+const Bitboard BISHOP_MAGICS[64] = {
+	0x20C0090901061081ULL, 0x0024040094030104ULL, 0x8210810200290200ULL, 0x0011040484620000ULL,
+	0x0081104002221000ULL, 0x0009012011001350ULL, 0x0081010802400380ULL, 0x0000420210010408ULL,
+	0x0008105002280050ULL, 0x0001028484040044ULL, 0x2A00880810408804ULL, 0x7020022282000100ULL,
+	0x0084040420100A50ULL, 0x000401010840E000ULL, 0x2020020210420888ULL, 0x0008084202012010ULL,
+	0x2010400810018800ULL, 0x0445122008020840ULL, 0x0804100808002008ULL, 0x0008002104110100ULL,
+	0x0061005820080800ULL, 0x2001000200820100ULL, 0x480C210084010800ULL, 0x3004442500480420ULL,
+	0x1010102240048100ULL, 0x00182009084220A3ULL, 0x8803090A10004205ULL, 0x0208080040202020ULL,
+	0x000C044084010040ULL, 0x00A1010002004106ULL, 0x6008210020640202ULL, 0x1600902112860801ULL,
+	0x00042008C1220200ULL, 0x010C042002440140ULL, 0x5022080200040820ULL, 0x0402004042940100ULL,
+	0x0860108400008020ULL, 0x000C080022021000ULL, 0x0264080652822100ULL, 0x4005031221010401ULL,
+	0x0004502410008400ULL, 0x000500B010A20400ULL, 0x0415094050080800ULL, 0x080000201800A104ULL,
+	0x4022A80304000110ULL, 0x4012140802028020ULL, 0x40200104010100A0ULL, 0x12810806008B0C41ULL,
+	0x0020441008080000ULL, 0x2002120084045420ULL, 0x0704020062080002ULL, 0x0000001084040001ULL,
+	0x0322200891240200ULL, 0xF040200210024800ULL, 0x0140824832008042ULL, 0x000210020A004602ULL,
+	0x0083042805141020ULL, 0x002C12009A011000ULL, 0x0041A00044140400ULL, 0x00004004020A0202ULL,
+	0x0000140010020210ULL, 0x2864160811012200ULL, 0x2060080841082A17ULL, 0xA010041108003100ULL
+};
+#else
+const Bitboard ROOK_MAGICS[64] = { 0 };
+const Bitboard BISHOP_MAGICS[64] = { 0 };
+#endif
+
+// Sliding attacks tables, initialized once by initSlidingTables()
+SlidingEntry rookEntries[SQUARES];
+SlidingEntry bishopEntries[SQUARES];
+Bitboard rookTable[ROOK_TABLE_SIZE];
+Bitboard bishopTable[BISHOP_TABLE_SIZE];
+int usePext = 0;
+
+/*
+	Reference positions for runPerftSuite(), with known numbers of nodes: the initial position,
+	position 3 of chessprogramming wiki and positions which test promotions, discovered checks,
+	self checks, castling through attacked squares, loss of castling rights, and en passant captures
+	which discover checks, evade checks or are illegal because of pins. position 2 (Kiwipete), 4 and 5
+	test all the rules together. the positions are of the standard board, so there are no references for
+	other sizes.
+*/
+#if SIZE == 8
+const PerftReference PERFT_REFERENCES[] = {
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", 1, 20 },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", 2, 400 },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", 3, 8902 },
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", 4, 197281 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", 1, 14 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", 2, 191 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", 3, 2812 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", 4, 43238 },
+	{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", 5, 674624 },
+	{ "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b", 4, 182838 },
+	{ "2K2r2/4P3/8/8/8/8/8/3k4 w", 6, 3821001 },
+	{ "8/8/1P2K3/8/2n5/1q6/8/5k2 b", 5, 1004658 },
+	{ "4k3/1P6/8/8/8/8/K7/8 w", 6, 217342 },
+	{ "8/P1k5/K7/8/8/8/8/8 w", 6, 92683 },
+	{ "K1k5/8/P7/8/8/8/8/8 w", 6, 2217 },
+	{ "8/k1P5/8/1K6/8/8/8/8 w", 7, 567584 },
+	{ "8/8/2k5/5q2/5n2/8/5K2/8 b", 4, 23527 },
+	{ "r3k2r/8/8/8/8/8/8/R3K2R w KQkq", 1, 26 },
+	{ "r3k2r/8/8/8/8/8/8/R3K2R w KQkq", 2, 568 },
+	{ "r3k2r/8/8/8/8/8/8/R3K2R w KQkq", 3, 13744 },
+	{ "r3k2r/8/8/8/8/8/8/R3K2R w KQkq", 4, 314346 },
+	{ "5k2/8/8/8/8/8/8/4K2R w K", 6, 661072 },
+	{ "3k4/8/8/8/8/8/8/R3K3 w Q", 6, 803711 },
+	{ "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq", 4, 1274206 },
+	{ "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq", 4, 1720476 },
+	{ "1k6/1b6/8/8/7R/8/8/4K2R b K", 5, 1063513 },
+	{ "3k4/3p4/8/K1P4r/8/8/8/8 b", 6, 1134888 },
+	{ "8/8/4k3/8/2p5/8/B2P2K1/8 w", 6, 1015133 },
+	{ "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3", 6, 1440467 },
+	{ "8/5bk1/8/2Pp4/8/1K6/8/8 w - d6", 6, 824064 },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq", 1, 48 },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq", 2, 2039 },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq", 3, 97862 },
+	{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq", 4, 4085603 },
+	{ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq", 3, 9467 },
+	{ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq", 4, 422333 },
+	{ "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379 },
+	{ "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 }
+};
+#define PERFT_REFERENCES_COUNT (int)(sizeof(PERFT_REFERENCES) / sizeof(PERFT_REFERENCES[0]))
+#else
+const PerftReference PERFT_REFERENCES[] = { { NULL, 0, 0 } };
+#define PERFT_REFERENCES_COUNT 0
+#endif
+
+// Squares between two squares and full line through two squares (0 if not on same line)
+Bitboard betweenSquares[SQUARES][SQUARES];
+Bitboard lineSquares[SQUARES][SQUARES];
+
+// Zobrist keys of any piece code on any square and of black turn, initialized by initZobristKeys()
+HashKey zobristPieces[NO_PIECE][SQUARES];
+HashKey zobristBlackTurn;
+HashKey zobristCastling[1 << CASTLING_MOVES];
+HashKey zobristEnPassant[SIZE];
+
+// Class and value of any char in SAN, initialized by initSanChars()
+unsigned char sanChars[256];
+
+/*
+	Middlegame and endgame scores (value and piece-square bonus, negative for black) of any piece
+	code on any square of board, initialized by initPieceSquareTables()
+*/
+int middlegameSquareScores[NO_PIECE][SQUARES];
+int endgameSquareScores[NO_PIECE][SQUARES];
+
+// Network of neural evaluation, memory is NULL until loadNnueNetwork() succeeds
+NnueNetwork nnueNetwork = { NULL, NULL, NULL, 0, NULL };
+
+// Castling moves in the order of the rights bits, and the rights which are kept when piece leaves or arrives to square
+CastlingMove castlingMoves[CASTLING_MOVES];
+int castlingMasks[SQUARES];
+
+#if PEXT_SUPPORT
+/*
+	Extraction of the occupied bits in mask by PEXT instruction. the function is compiled for BMI2
+	and called only after the CPU support is checked.
+*/
+__attribute__((target("bmi2"))) Bitboard extractBits(Bitboard occupied, Bitboard mask) {
+	return _pext_u64(occupied, mask);
+}
+#endif
+
+// Directions (row, column) of sliding pieces
+const int ROOK_DIRECTIONS[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+const int BISHOP_DIRECTIONS[4][2] = { { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+
 /*************************************************************************************************
 *	Function name: toDigit
 *	Input: char c
@@ -139,69 +336,17 @@ void printRow(char row[], int rowIdx) {
 	printf("| %d\n", rowIdx);
 }
 
-/*************************************************************************************************
-*	Function name: createRow
-*	Input: char fenString[], char boardRow[]
-*	Output: None
-*	Function Operation: this function received pointer to 2D array which represents chess board.
-*	According to FEN received, the function inserts the relevant pieces and spaces to board.
-***************************************************************************************************/
-void createRow(char fenString[], char boardRow[]) {
-
-	int i = 0;
-	int c = 0;
-
-	/*
-		While loop which inserts the relevant pieces and spaces.
-	*/
-	while (fenString[c] != '\0') {
-
-		//If the FEN include digit, fill the row in spacse according to digit value
-		if (isdigit(fenString[c])) {
-			int spaces = toDigit(fenString[c]);
-			for (int z = 0; z < spaces; z++) {
-				boardRow[i] = EMPTY;
-				i++;
-			}
-		}
-
-		// If the FEN include letter, insert the relevant piece to row.
-		else {
-
-			boardRow[i] = fenString[c];
-			i++;
-		}
-		c++;
-	}
-
-}
-
 /*************************************************************************************************
 *	Function name: createBoard
 *	Input: char board[][SIZE], char fen[]
 *	Output: None
 *	Function Operation: this function create chessboard according to FEN which recieved
-*	on 2D array given. At first, the function parse the FEN string to the rows that any part represents.
-*	any partial FEN string which was parsed, will be send to function createRow which described below.
+*	on 2D array given. the FEN is converted by fenToBoard(), which doesn't change the FEN and has
+*	no global state. in case of invalid FEN, the squares which were parsed before the error are
+*	filled and the rest are empty.
 ***************************************************************************************************/
 void createBoard(char board[][SIZE], char fen[]) {
-
-	int i = 0;
-	char* fenRow = strtok(fen, SEP);
-	char* partialFen[SIZE] = {'\0'};
-
-	//Parsing the FEN to the rows that any part represents
-	while (fenRow != NULL) {
-		partialFen[i++] = fenRow;
-		fenRow = strtok(NULL, SEP);
-	}
-
-	//For any row in partial FEN, direct to createRow function
-	for (int i = 0; i < SIZE; i++) {
-		createRow(partialFen[i], board[i]);
-	}
-
-
+	fenToBoard(fen, -1, board);
 }
 
 /*************************************************************************************************
@@ -229,2089 +374,6022 @@ void printBoard(char board[][SIZE]) {
 	}
 	printSpacers();
 	printColumns();
+}
+
+
+
+//bitboard position
+
 
+/*************************************************************************************************
+*	Function name: squareBit
+*	Input: int square
+*	Output: Bitboard
+*	Function Operation: the function returns bitboard with single bit which represents the square.
+***************************************************************************************************/
+Bitboard squareBit(int square) {
+	return 1ULL << square;
 }
 
 /*************************************************************************************************
-*	Function name: convertPieceChar
-*	Input: Move move
-*	Output: char move.srcPiece
-*	Function Operation: this function recieved Struct Move. According to the color turn, return
-*	the relevant source pieces char. capital case letters represent white pieces and lower case letters
-*	represent black pieces.
+*	Function name: squareIndex
+*	Input: int i, int j
+*	Output: int (values between 0 to SQUARES - 1)
+*	Function Operation: the function converts row and column indexes of 2D array to square index
+*	in bitboard position.
 ***************************************************************************************************/
-char convertPieceChar(Move move) {
+int squareIndex(int i, int j) {
+	return i * SIZE + j;
+}
 
-	if (!move.isWhite) {
-		return tolower(move.srcPiece);
-	}
-	return move.srcPiece;
+/*************************************************************************************************
+*	Function name: lowestSquare
+*	Input: Bitboard bitboard
+*	Output: int square
+*	Function Operation: the function returns the index of the lowest square which is set in the
+*	bitboard. the bitboard must not be empty.
+***************************************************************************************************/
+int lowestSquare(Bitboard bitboard) {
+	assert(bitboard);
+#if defined(_MSC_VER)
+	unsigned long square;
+	_BitScanForward64(&square, bitboard);
+	return (int)square;
+#else
+	return __builtin_ctzll(bitboard);
+#endif
+}
 
+/*************************************************************************************************
+*	Function name: popLowestSquare
+*	Input: Bitboard* bitboard
+*	Output: int square
+*	Function Operation: the function returns the index of the lowest square which is set in the
+*	bitboard and removes this square from the bitboard.
+***************************************************************************************************/
+int popLowestSquare(Bitboard* bitboard) {
+	int square = lowestSquare(*bitboard);
+	*bitboard &= *bitboard - 1;
+	return square;
 }
 
+/*************************************************************************************************
+*	Function name: countSquares
+*	Input: Bitboard bitboard
+*	Output: int (number of squares)
+*	Function Operation: the function returns the number of squares which are set in the bitboard.
+***************************************************************************************************/
+int countSquares(Bitboard bitboard) {
+#if defined(_MSC_VER)
+	return (int)__popcnt64(bitboard);
+#else
+	return __builtin_popcountll(bitboard);
+#endif
+}
 
-//initialize move by parsing PGN
+/*************************************************************************************************
+*	Function name: encodeMove
+*	Input: int src, int dest, int promotionType
+*	Output: EncodedMove
+*	Function Operation: the function packs the source and destination squares and the promotion
+*	piece type (-1 if there is no promotion) into 16 bits move.
+***************************************************************************************************/
+EncodedMove encodeMove(int src, int dest, int promotionType) {
+	int flags = promotionType >= 0 ? MOVE_PROMOTION | (promotionType - KNIGHT_TYPE) : 0;
+	return (EncodedMove)(src | (dest << 6) | (flags << 12));
+}
 
+/*************************************************************************************************
+*	Function name: moveSrc
+*	Input: EncodedMove move
+*	Output: int (source square)
+*	Function Operation: the function returns the source square of encoded move.
+***************************************************************************************************/
+int moveSrc(EncodedMove move) {
+	return move & 63;
+}
 
 /*************************************************************************************************
-*	Function name: initMove
-*	Input: char board[][SIZE], char pgn[], int isWhiteTurn
-*	Output: Move moveToCheck
-*	Function Operation: this function initialize Struct Move according to PGN string which recived
-*	and according to the turn color. the function use sub-functions which parse the infromation from
-*	the PGN string. Then, when the Move is initialized, function send the move to additional
-*	sub-function to check for optional piece which Meets Move conditions.
-*	At the end, the initialized move return.
+*	Function name: moveDest
+*	Input: EncodedMove move
+*	Output: int (destination square)
+*	Function Operation: the function returns the destination square of encoded move.
 ***************************************************************************************************/
-Move initMove(char board[][SIZE], char pgn[], int isWhiteTurn) {
+int moveDest(EncodedMove move) {
+	return (move >> 6) & 63;
+}
 
-	Move initMove;
+/*************************************************************************************************
+*	Function name: movePromotionType
+*	Input: EncodedMove move
+*	Output: int (piece type index or -1)
+*	Function Operation: the function returns the promotion piece type of encoded move, or -1 if
+*	the move is not promotion.
+***************************************************************************************************/
+int movePromotionType(EncodedMove move) {
+	int flags = move >> 12;
+	return (flags & MOVE_PROMOTION) ? KNIGHT_TYPE + (flags & 3) : -1;
+}
 
-	// Default initialization as legal move
-	initMove.isLegal = 1;
+/*************************************************************************************************
+*	Function name: pieceTypeFromChar
+*	Input: char piece
+*	Output: int (piece type index or -1)
+*	Function Operation: the function converts piece char in any color to piece type index.
+*	if the char does not represent chess piece, -1 returned.
+***************************************************************************************************/
+int pieceTypeFromChar(char piece) {
+	const char* found = strchr(PIECE_CHARS, toupper(piece));
+	if (piece == '\0' || found == NULL) {
+		return -1;
+	}
+	return (int)(found - PIECE_CHARS);
+}
 
-	// Define the color of turn
-	if (isWhiteTurn) {
-		initMove.isWhite = 1;
+/*************************************************************************************************
+*	Function name: pieceCharFromCode
+*	Input: int pieceCode
+*	Output: char
+*	Function Operation: the function converts piece code from position mailbox to the char which
+*	represents it on 2D array board. capital case letters represent white pieces and lower case
+*	letters represent black pieces. empty square is converted to EMPTY.
+***************************************************************************************************/
+char pieceCharFromCode(int pieceCode) {
+	if (pieceCode == NO_PIECE) {
+		return EMPTY;
 	}
-	else {
-		initMove.isWhite = 0;
+	char piece = PIECE_CHARS[pieceCode % PIECE_TYPES];
+	if (pieceCode / PIECE_TYPES == BLACK_COLOR) {
+		return tolower(piece);
 	}
+	return piece;
+}
 
-	// Define the source location on board (if exist) and the soruce piece type
-	initMove = parseSrcFromPgn(pgn, initMove);
-
-	// Define the destination location
-	initMove = parseDestFromPgn(pgn, initMove);
-
-	// Convert the source location on board to matrix indexs
-	initMove = convertSrcMatrixIndex(initMove);
+/*************************************************************************************************
+*	Function name: clearPosition
+*	Input: Position* position
+*	Output: None
+*	Function Operation: the function initializes position with empty board, white turn, no castling
+*	rights or en passant square and clocks of new game. if network is loaded, the hidden layer gets
+*	its biases. the tables of game are initialized by the callers, so reset of position only clears.
+***************************************************************************************************/
+void clearPosition(Position* position) {
+	memset(position, 0, sizeof(Position));
+	memset(position->mailbox, NO_PIECE, sizeof(position->mailbox));
+	position->isWhiteTurn = 1;
+	position->enPassantSquare = -1;
+	position->fullmoveNumber = 1;
+	position->kingSquare[WHITE_COLOR] = -1;
+	position->kingSquare[BLACK_COLOR] = -1;
+	if (nnueNetwork.memory != NULL) {
+		memcpy(position->accumulator[WHITE_COLOR], nnueNetwork.featureBiases, sizeof(short) * NNUE_HIDDEN);
+		memcpy(position->accumulator[BLACK_COLOR], nnueNetwork.featureBiases, sizeof(short) * NNUE_HIDDEN);
+	}
+}
 
-	// Convert the destination location on board to matrix indexs
-	initMove = convertDestMatrixIndex(initMove);
+/*************************************************************************************************
+*	Function name: placePiece
+*	Input: Position* position, int color, int type, int square
+*	Output: None
+*	Function Operation: the function puts piece on empty square of position. the piece bitboard,
+*	the color occupancy, the total occupancy, the mailbox, the king square, the Zobrist key and
+*	the evaluation terms (and the hidden layer of network, if it is loaded) are updated together.
+***************************************************************************************************/
+void placePiece(Position* position, int color, int type, int square) {
+	Bitboard bit = squareBit(square);
+	position->pieces[color][type] |= bit;
+	position->occupancy[color] |= bit;
+	position->allPieces |= bit;
+	position->mailbox[square] = color * PIECE_TYPES + type;
+	position->key ^= zobristPieces[color * PIECE_TYPES + type][square];
+	position->middlegameScore += middlegameSquareScores[color * PIECE_TYPES + type][square];
+	position->endgameScore += endgameSquareScores[color * PIECE_TYPES + type][square];
+	position->phase += PHASE_WEIGHTS[type];
+	if (nnueNetwork.memory != NULL) {
+		addNnuePiece(position, color * PIECE_TYPES + type, square, 1);
+	}
+	if (type == KING_TYPE) {
+		position->kingSquare[color] = square;
+	}
+}
 
-	// Define the piece type which exist in destination location
-	initMove.destPiece = findDestPiece(initMove.iDest, initMove.jDest, board);
+/*************************************************************************************************
+*	Function name: removePiece
+*	Input: Position* position, int square
+*	Output: None
+*	Function Operation: the function removes the piece which located on square of position, and
+*	removes its Zobrist key from the key of position and its scores from the evaluation terms
+*	and from the hidden layer of network. if the square is empty, nothing is changed.
+***************************************************************************************************/
+void removePiece(Position* position, int square) {
+	int pieceCode = position->mailbox[square];
+	if (pieceCode == NO_PIECE) {
+		return;
+	}
+	Bitboard bit = squareBit(square);
+	position->pieces[pieceCode / PIECE_TYPES][pieceCode % PIECE_TYPES] &= ~bit;
+	position->occupancy[pieceCode / PIECE_TYPES] &= ~bit;
+	position->allPieces &= ~bit;
+	position->mailbox[square] = NO_PIECE;
+	position->key ^= zobristPieces[pieceCode][square];
+	position->middlegameScore -= middlegameSquareScores[pieceCode][square];
+	position->endgameScore -= endgameSquareScores[pieceCode][square];
+	position->phase -= PHASE_WEIGHTS[pieceCode % PIECE_TYPES];
+	if (nnueNetwork.memory != NULL) {
+		addNnuePiece(position, pieceCode, square, 0);
+	}
+	if (pieceCode % PIECE_TYPES == KING_TYPE) {
+		position->kingSquare[pieceCode / PIECE_TYPES] = -1;
+	}
+}
 
-	// Define move conditions such as: capture, check, mate, promotion
-	initMove = parseConditionFromPgn(pgn, initMove);
+/*************************************************************************************************
+*	Function name: parseFenNumber
+*	Input: const char fen[], int length, int* c, int* number
+*	Output: int (0 or 1)
+*	Function Operation: the function parses non negative decimal number in fen from index c, and
+*	moves c after it. if there is no digit in index c or the number is too big, 0 return.
+***************************************************************************************************/
+int parseFenNumber(const char fen[], int length, int* c, int* number) {
 
-	// Send the initialized Move to check for optional piece which Meets Move conditions.
-	Move moveToCheck = findOptionalPieceByMove(board, initMove);
+	int start = *c;
 
-	return moveToCheck;
+	*number = 0;
+	while (*c < length && isdigit((unsigned char)fen[*c])) {
+		if (*number > 99999999) {
+			return 0;
+		}
+		*number = *number * 10 + toDigit(fen[(*c)++]);
+	}
+	return *c > start;
 }
 
 /*************************************************************************************************
-*	Function name: parseSrcFromPgn
-*	Input: char pgn[], Move move
-*	Output: Move move
-*	Function Operation: this function parse Source infromation from PGN and define it in Move.
-*	(1)	function parse the source row of the piece by finding the relevant digit in PGN.
-*	(2) function parse the source column of the piece by finding the relevant lower case letter in PGN.
-*	(3) function parse the soruce piece type by finding the relevant capital case letter in PGN.
+*	Function name: parseFen
+*	Input: const char fen[], int length, FenFields* fields
+*	Output: int (FEN_OK or error code)
+*	Function Operation: the function parses the first length chars of fen (until NUL, or the whole
+*	NUL terminated string if length is negative) to its six fields. fen is not changed and no
+*	global state is used, so any number of threads may parse together, also from read only buffers.
+*	(1) pieces placement: SIZE rows separated by '/', any row has SIZE squares of pieces and digits
+*		of empty squares.
+*	(2) side to move: 'w' or 'b'.
+*	(3) castling rights: '-' or any of "KQkq" without repeats.
+*	(4) en passant target square: '-' or square on the row behind Pawn which just moved two steps.
+*	(5) halfmove clock and (6) fullmove number: non negative numbers.
+*	the fields are separated by spaces. any field after the placement may be missing, and then
+*	it gets its default value: white turn, no castling and en passant, clocks 0 and 1.
 ***************************************************************************************************/
-Move parseSrcFromPgn(char pgn[], Move move) {
-
-	// Varialbles which are used to count the chars to find the relevant row and column
-	int srcRowCounter = 0;
-	int srcColCounter = 0;
+int parseFen(const char fen[], int length, FenFields* fields) {
 
-	// Varibale which are used as flags for row and column that has been found
-	int srcRowFound = 0;
-	int srcColFound = 0;
+	int c = 0;
+	int i = 0;
+	int j = 0;
+
+	fields->isWhiteTurn = 1;
+	fields->castlingRights = 0;
+	fields->enPassantSquare = -1;
+	fields->halfmoveClock = 0;
+	fields->fullmoveNumber = 1;
+	for (int square = 0; square < SQUARES; square++) {
+		fields->mailbox[square] = NO_PIECE;
+	}
 
-	// For loop which run on the length of the PGN string from the end
-	for (int i = strlen(pgn) - 1; i >= 0; i--) {
+	// Negative length means NUL terminated fen, and NUL ends the fen in any case
+	if (length < 0) {
+		length = (int)strlen(fen);
+	}
+	const char* end = memchr(fen, '\0', length);
+	if (end != NULL) {
+		length = (int)(end - fen);
+	}
 
-		//If there is more than one digit, so the first digit represents the src row
-		if (isdigit(pgn[i])) {
-			srcRowCounter++;
-			if (srcRowCounter > 1 && !srcRowFound) {
-				move.srcRow = pgn[i];
-				srcRowFound = 1;
+	// Pieces placement, until the end or the first space
+	for (; c < length && fen[c] != ' '; c++) {
+		if (fen[c] == SEP[0]) {
+			if (j != SIZE || ++i >= SIZE) {
+				return j != SIZE ? FEN_BAD_ROW : FEN_BAD_ROWS_COUNT;
 			}
+			j = 0;
 		}
-
-		// If there is more than one lower case letter, so the first letter represents the src column
-		if (pgn[i] >= 'a' && pgn[i] <= 'z' && pgn[i] != 'x') {
-			srcColCounter++;
-			if (srcColCounter > 1 && !srcColFound) {
-				move.srcCol = pgn[i];
-				srcColFound = 1;
+		else if (fen[c] >= '1' && fen[c] <= '9') {
+			j += toDigit(fen[c]);
+			if (j > SIZE) {
+				return FEN_BAD_ROW;
+			}
+		}
+		else {
+			int type = pieceTypeFromChar(fen[c]);
+			if (type < 0 || !isalpha((unsigned char)fen[c])) {
+				return FEN_BAD_PIECE;
+			}
+			if (j >= SIZE) {
+				return FEN_BAD_ROW;
 			}
+			fields->mailbox[squareIndex(i, j++)] = (isupper((unsigned char)fen[c]) ? WHITE_COLOR : BLACK_COLOR) * PIECE_TYPES + type;
 		}
+	}
+	if (j != SIZE) {
+		return FEN_BAD_ROW;
+	}
+	if (i != SIZE - 1) {
+		return FEN_BAD_ROWS_COUNT;
+	}
 
+	// Side to move
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	if (c == length) {
+		return FEN_OK;
+	}
+	if ((fen[c] != 'w' && fen[c] != 'b') || (c + 1 < length && fen[c + 1] != ' ')) {
+		return FEN_BAD_SIDE;
 	}
+	fields->isWhiteTurn = fen[c++] == 'w';
 
-	if (!srcRowFound) {
-		move.srcRow = '\0';
+	// Castling rights
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	if (c == length) {
+		return FEN_OK;
+	}
+	if (fen[c] == '-') {
+		c++;
+	}
+	else {
+		for (; c < length && fen[c] != ' '; c++) {
+			const char* found = strchr(CASTLING_CHARS, fen[c]);
+			int right = found != NULL && fen[c] != '\0' ? 1 << (found - CASTLING_CHARS) : 0;
+			if (!right || (fields->castlingRights & right)) {
+				return FEN_BAD_CASTLING;
+			}
+			fields->castlingRights |= right;
+		}
 	}
-	if (!srcColFound) {
-		move.srcCol = '\0';
+	if (c < length && fen[c] != ' ') {
+		return FEN_BAD_CASTLING;
 	}
 
-	/*
-	Checking the first char in PGN string.
-	If there is char between A-Z , this char represents the source piece type
-	If there is no capital char, so the relevant piece type is Pawn.
-	*/
-	if (pgn[0] >= 'A' && pgn[0] <= 'Z') {
-		move.srcPiece = pgn[0];
+	// En passant target square, behind Pawn of the opponent which moved two steps
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	if (c == length) {
+		return FEN_OK;
+	}
+	if (fen[c] == '-') {
+		c++;
 	}
 	else {
-		move.srcPiece = 'P';
+		int row = 0;
+		int col = fen[c++] - FIRST_COL;
+		if (col < 0 || col >= SIZE || !parseFenNumber(fen, length, &c, &row)
+			|| SIZE - row != (fields->isWhiteTurn ? 2 : SIZE - 3)) {
+			return FEN_BAD_EN_PASSANT;
+		}
+		fields->enPassantSquare = squareIndex(SIZE - row, col);
+	}
+	if (c < length && fen[c] != ' ') {
+		return FEN_BAD_EN_PASSANT;
 	}
 
-	return move;
+	// Halfmove clock and fullmove number
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	if (c == length) {
+		return FEN_OK;
+	}
+	if (!parseFenNumber(fen, length, &c, &fields->halfmoveClock) || (c < length && fen[c] != ' ')) {
+		return FEN_BAD_CLOCK;
+	}
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	if (c == length) {
+		return FEN_OK;
+	}
+	if (!parseFenNumber(fen, length, &c, &fields->fullmoveNumber) || (c < length && fen[c] != ' ')) {
+		return FEN_BAD_CLOCK;
+	}
 
+	// Nothing but spaces after the six fields
+	while (c < length && fen[c] == ' ') {
+		c++;
+	}
+	return c == length ? FEN_OK : FEN_EXTRA_DATA;
 }
 
 /*************************************************************************************************
-*	Function name: parseDestFromPgn
-*	Input: char pgn[], Move move
-*	Output: Move move
-*	Function Operation:
-*	(1)	function parse the destination row of the piece by finding the relevant digit in PGN.
-*	(2) function parse the destination column of the piece by finding the relevant lower case letter in PGN.
+*	Function name: parseFenBulk
+*	Input: const char text[], size_t length, FenFields fields[], int errors[], int maxCount
+*	Output: int (number of parsed FENs)
+*	Function Operation: the function parses text of FENs, one FEN in line, in single pass without
+*	copying or allocating. the fields and the error code of the n-th FEN are stored in fields[n]
+*	and errors[n]. empty lines are skipped and "\r\n" line ends are accepted. the parsing stops
+*	after maxCount FENs.
 ***************************************************************************************************/
-Move parseDestFromPgn(char pgn[], Move move) {
+int parseFenBulk(const char text[], size_t length, FenFields fields[], int errors[], int maxCount) {
+
+	size_t start = 0;
+	int count = 0;
 
-	// Varibale which are used as flags for row and column that has been found
-	int destRowFound = 0;
-	int destColFound = 0;
+	while (start < length && count < maxCount) {
 
-	// For loop which run on the length of the PGN string from the end
-	for (int i = strlen(pgn) - 1; i >= 0; i--) {
-		//The first digit which found represents the destination row
-		if (isdigit(pgn[i]) && !destRowFound) {
-			move.destRow = pgn[i];
-			destRowFound = 1;
+		const char* newline = memchr(text + start, '\n', length - start);
+		size_t end = newline != NULL ? (size_t)(newline - text) : length;
+		size_t lineEnd = end;
+
+		if (lineEnd > start && text[lineEnd - 1] == '\r') {
+			lineEnd--;
 		}
-		//The first digit which found represents the destination column
-		if (pgn[i] >= 'a' && pgn[i] <= 'z' && !destColFound) {
-			move.destCol = pgn[i];
-			destColFound = 1;
+		if (lineEnd > start) {
+			errors[count] = parseFen(text + start, (int)(lineEnd - start), &fields[count]);
+			count++;
 		}
+		start = end + 1;
 	}
+	return count;
+}
 
-	return move;
-
+/*************************************************************************************************
+*	Function name: fenErrorText
+*	Input: int error
+*	Output: const char* (description)
+*	Function Operation: the function returns description of FEN error code of parseFen().
+***************************************************************************************************/
+const char* fenErrorText(int error) {
+	switch (error) {
+	case FEN_OK:
+		return "valid FEN";
+	case FEN_BAD_PIECE:
+		return "unknown piece in placement";
+	case FEN_BAD_ROW:
+		return "row without exactly SIZE squares";
+	case FEN_BAD_ROWS_COUNT:
+		return "placement without exactly SIZE rows";
+	case FEN_BAD_SIDE:
+		return "side to move is not 'w' or 'b'";
+	case FEN_BAD_CASTLING:
+		return "bad castling rights";
+	case FEN_BAD_EN_PASSANT:
+		return "bad en passant square";
+	case FEN_BAD_CLOCK:
+		return "bad halfmove clock or fullmove number";
+	case FEN_EXTRA_DATA:
+		return "extra data after fullmove number";
+	}
+	return "unknown error";
 }
 
 /*************************************************************************************************
-*	Function name: convertSrcMatrixIndex
-*	Input: Move move
-*	Output: Move move
-*	Function Operation: the function converts the source row and column which initilaized in Move,
-*	to the the appropriate index in 2D array. initialize the iSrc and jSrc in Move.
+*	Function name: createPosition
+*	Input: Position* position, const char fen[]
+*	Output: int (FEN_OK or error code)
+*	Function Operation: this function creates bitboard position according to FEN which recieved.
+*	the FEN is parsed by parseFen(), and any piece of the placement is put on its square and the
+*	turn is defined according to the side to move. castling right of FEN is kept only if its King
+*	and Rook are on their squares, and en passant square only if the capture is possible. the
+*	clocks are taken from FEN. in case of invalid FEN, the error code of parseFen() return and
+*	the position is left empty.
 ***************************************************************************************************/
-Move convertSrcMatrixIndex(Move move) {
+int createPosition(Position* position, const char fen[]) {
 
-	//Default iSrc to use as flag for iSrc which not accepted
-	move.iSrc = -1;
+	FenFields fields;
+	int error = parseFen(fen, -1, &fields);
 
-	/*
-		If there is source row which was parsed from PGN,
-		run on loop in SIZE length and convert it to the appropriate index in 2D array.
-	*/
-	if (move.srcRow != '\0') {
-		int iSrc = SIZE - 1;
-		for (int i = 1; i <= SIZE; i++) {
-			if (toDigit(move.srcRow) == i) {
-				move.iSrc = iSrc;
-				break;
-			}
-			iSrc--;
-		}
+	initChessGame();
+	clearPosition(position);
+	if (error != FEN_OK) {
+		computeCheckState(position);
+		return error;
 	}
 
-
-	//Default jSrc to use as flag for jSrc which not accepted
-	move.jSrc = -1;
-
-	/*
-		If there is source column which was parsed from PGN,
-		run on loop in SIZE length and convert it to the appropriate index in 2D array.
-	*/
-	if (move.srcCol != '\0') {
-		char jSrc = 'a';
-		for (int i = 0; i < SIZE; i++) {
-			if (move.srcCol == jSrc) {
-				move.jSrc = i;
-				break;
-			}
-			jSrc++;
+	for (int square = 0; square < SQUARES; square++) {
+		int pieceCode = fields.mailbox[square];
+		if (pieceCode != NO_PIECE) {
+			placePiece(position, pieceCode / PIECE_TYPES, pieceCode % PIECE_TYPES, square);
 		}
 	}
+	position->isWhiteTurn = fields.isWhiteTurn;
+	if (!position->isWhiteTurn) {
+		position->key ^= zobristBlackTurn;
+	}
+	setCastlingRights(position, fields.castlingRights & placementCastlingRights(position));
+	if (fields.enPassantSquare >= 0 && isEnPassantPossible(position, fields.enPassantSquare)) {
+		setEnPassantSquare(position, fields.enPassantSquare);
+	}
+	position->halfmoveClock = fields.halfmoveClock;
+	position->fullmoveNumber = fields.fullmoveNumber;
 
-	return move;
+	computeCheckState(position);
+	return FEN_OK;
 }
 
 /*************************************************************************************************
-*	Function name: convertDestMatrixIndex
-*	Input: Move move
-*	Output: Move move
-*	Function Operation: the function converts the destination row and column which initilaized in Move,
-*	to the the appropriate index in 2D array. initialize the iDest and jDest in Move.
+*	Function name: loadPosition
+*	Input: Position* position, char board[][SIZE], int isWhiteTurn
+*	Output: None
+*	Function Operation: this function creates bitboard position from the 2D array board and the
+*	color of turn which recieved. 2D array has no history, so castling is allowed for any King and
+*	Rook which are on their initial squares.
 ***************************************************************************************************/
-Move convertDestMatrixIndex(Move move) {
-
-
-	int iDest = SIZE - 1;
+void loadPosition(Position* position, char board[][SIZE], int isWhiteTurn) {
 
-	//For loop in SIZE length and convert the destination row to the appropriate index in 2D array.
-	for (int i = 1; i <= SIZE; i++) {
-		if (toDigit(move.destRow) == i) {
-			move.iDest = iDest;
-			break;
-		}
-		iDest--;
+	initChessGame();
+	clearPosition(position);
+	position->isWhiteTurn = isWhiteTurn;
+	if (!isWhiteTurn) {
+		position->key = zobristBlackTurn;
 	}
 
-	//For loop in SIZE length and convert the destination column to the appropriate index in 2D array.
-	char jDest = 'a';
 	for (int i = 0; i < SIZE; i++) {
-		if (move.destCol == jDest) {
-			move.jDest = i;
-			break;
+		for (int j = 0; j < SIZE; j++) {
+			int type = pieceTypeFromChar(board[i][j]);
+			if (type >= 0) {
+				placePiece(position, isupper(board[i][j]) ? WHITE_COLOR : BLACK_COLOR, type, squareIndex(i, j));
+			}
 		}
-		jDest++;
 	}
+	setCastlingRights(position, placementCastlingRights(position));
 
-	return move;
+	computeCheckState(position);
 }
 
 /*************************************************************************************************
-*	Function name: parseConditionFromPgn
-*	Input: char pgn[], Move move
-*	Output: Move move
-*	Function Operation: the function parses the information from PGN string about several conditions
-*	such as capture, check, mate and promotion. any feature is initialized in Move.
+*	Function name: positionToBoard
+*	Input: Position* position, char board[][SIZE]
+*	Output: None
+*	Function Operation: this function derives 2D array board from the bitboard position.
+*	the 2D array is needed only in order to print the position or to return it to caller
+*	which holds 2D array board.
 ***************************************************************************************************/
-Move parseConditionFromPgn(char pgn[], Move move) {
-
-	// Default initialization
-	move.isCapture = 0;
-	move.isCheck = 0;
-	move.isMate = 0;
-	move.isPromotion = 0;
-
-	/*
-		For loop which run on the PGN string length.
-		If there is identification in PGN of condition sign
-		so this feature is initialized in Move.
-	*/
-	for (int i = 0; i < strlen(pgn); i++) {
-		if (pgn[i] == 'x') {
-			move.isCapture = 1;
-		}
-		if (pgn[i] == '+') {
-			move.isCheck = 1;
-		}
-		if (pgn[i] == '#') {
-			move.isMate = 1;
-		}
-		if (pgn[i] == '=') {
-			move.isPromotion = 1;
-			move.promotionPiece = pgn[++i];;
+void positionToBoard(Position* position, char board[][SIZE]) {
+	for (int i = 0; i < SIZE; i++) {
+		for (int j = 0; j < SIZE; j++) {
+			board[i][j] = pieceCharFromCode(position->mailbox[squareIndex(i, j)]);
 		}
 	}
+}
 
-	return move;
+/*************************************************************************************************
+*	Function name: pieceAt
+*	Input: Position* position, int i, int j
+*	Output: char
+*	Function Operation: this function returns the char of the piece on row i and column j of
+*	position (as in 2D array board), or EMPTY.
+***************************************************************************************************/
+char pieceAt(Position* position, int i, int j) {
+	return pieceCharFromCode(position->mailbox[squareIndex(i, j)]);
 }
 
 /*************************************************************************************************
-*	Function name: findDestPiece
-*	Input: int iDest, int jDest, char board[][SIZE]
-*	Output: char destPiece
-*	Function Operation: this function find the destination piece in the 2D array given according
-*	to specific row and column which recieved.
+*	Function name: isInCheck
+*	Input: Position* position
+*	Output: int (0 or 1)
+*	Function Operation: this function returns 1 if the side to move is in check, otherwise 0.
+*	the answer is the check state which is kept in position.
 ***************************************************************************************************/
-char findDestPiece(int iDest, int jDest, char board[][SIZE]) {
-	char destPiece = board[iDest][jDest];
-	return destPiece;
+int isInCheck(Position* position) {
+	return position->checkers != 0;
 }
 
+/*************************************************************************************************
+*	Function name: printPosition
+*	Input: Position* position
+*	Output: None
+*	Function Operation: this function prints the bitboard position. the 2D array board is derived
+*	from position and printed by printBoard().
+***************************************************************************************************/
+void printPosition(Position* position) {
+	char board[SIZE][SIZE];
+	positionToBoard(position, board);
+	printBoard(board);
+}
 
 
-//Find optional source + tests
+//attacks computation
 
 
 /*************************************************************************************************
-*	Function name: findOptionalPieceByMove
-*	Input: char board[][SIZE], Move move
-*	Output: Move move
-*	Function Operation: this function recieved initialized Move and according to the type of source
-*	piece, try to find optional piece on board, which can make this Move.
-*	Any type of piece has his appropriate way to locate His position on the board, in a way that it
-*	will be able to arrive to the requested destination. When the optional piece is founded,
-*	this option is sent to sub-function which check if the move is legal according to piece type.
+*	Function name: rayAttacks
+*	Input: int square, Bitboard occupied, const int directions[][2], int directionsCount
+*	Output: Bitboard attacks
+*	Function Operation: this function returns the squares which sliding piece can attack from
+*	square. in any direction, the ray continues until the edge of board or until the first
+*	occupied square, which is included in attacks (it may be captured).
 ***************************************************************************************************/
-Move findOptionalPieceByMove(char board[][SIZE], Move move) {
-
-	// Variables which used to hold the advance source row and source column, in case were provided in PGN
-	int advRowSrc = move.iSrc;
-	int advColSrc = move.jSrc;
+Bitboard rayAttacks(int square, Bitboard occupied, const int directions[][2], int directionsCount) {
 
-	//Switch case according to source piece type
-	switch (move.srcPiece) {
+	Bitboard attacks = 0;
 
-	/*
-		In case of Rook.
-		The Rook can move in straight lines along the columns or rows.
-		There are two loops - one for rows and one for columns, with several
-		iterations according to board SIZE value.
-	*/
-	case 'R': {
-
-		Move rookMove = move;
-
-		// Variable which holds the char which represents rook by color turn
-		char rookChar = convertPieceChar(move);
-
-		//For loop on rows and the column is constant
-		for (int i = 0; i < SIZE; i++) {
-
-			/*
-				If there is square with Rook, send the optinal move to sub-function to check if legal.
-				if this is legal Move, so the source row and column are defined.
-				In case of two optional pieces were detected, there is advance information about the source row or column.
-				So there is check if there is match between the row and column which founded.
-			*/
-			if (board[i][move.jDest] == rookChar && i != move.iDest) {
-				rookMove = checkRookMove(board, move, i, move.jDest);
-				if (rookMove.isLegal) {
-					rookMove.iSrc = i;
-					rookMove.jSrc = move.jDest;
-					if ((advRowSrc >= 0 && rookMove.iSrc != advRowSrc) || (advColSrc >= 0 && rookMove.jSrc != advColSrc)) {
-						continue;
-					}
-					return rookMove;
-				}
+	for (int z = 0; z < directionsCount; z++) {
+		int i = square / SIZE + directions[z][0];
+		int j = square % SIZE + directions[z][1];
+		while (i >= 0 && i < SIZE && j >= 0 && j < SIZE) {
+			Bitboard bit = squareBit(squareIndex(i, j));
+			attacks |= bit;
+			if (occupied & bit) {
+				break;
 			}
+			i += directions[z][0];
+			j += directions[z][1];
 		}
-		//For loop on columns and the row is constant
-		for (int j = 0; j < SIZE; j++) {
+	}
+	return attacks;
+}
 
-			/*
-			If there is square with Rook, send the optinal move to sub-function to check if legal.
-			if this is legal Move, so the source row and column are defined.
-			In case of two optional pieces were detected, there is advance information about the source row or column.
-			So there is check if there is match between the row and column which founded.
-			*/
-			if (board[move.iDest][j] == rookChar && j != move.jDest) {
-				rookMove = checkRookMove(board, move, move.iDest, j);
-				if (rookMove.isLegal) {
-					rookMove.iSrc = move.iDest;
-					rookMove.jSrc = j;
-					if ((advRowSrc >= 0 && rookMove.iSrc != advRowSrc) || (advColSrc >= 0 && rookMove.jSrc != advColSrc)) {
-						continue;
-					}
-					return rookMove;
-				}
-			}
-		}
+/*************************************************************************************************
+*	Function name: relevantOccupancy
+*	Input: int square, const int directions[][2]
+*	Output: Bitboard mask
+*	Function Operation: this function returns the squares which may block sliding piece on square.
+*	these are the squares of any ray from square, except the last square on the edge of board,
+*	because piece on the edge square can't block any other square behind it.
+***************************************************************************************************/
+Bitboard relevantOccupancy(int square, const int directions[][2]) {
 
-		// In case no legal move detected, change rookMove.isLegal to 0 and return
-		rookMove.isLegal = 0;
-		return rookMove;
+	Bitboard mask = 0;
 
+	for (int z = 0; z < 4; z++) {
+		int i = square / SIZE + directions[z][0];
+		int j = square % SIZE + directions[z][1];
+
+		//The square is added only if the next square in direction is still on board
+		while (i + directions[z][0] >= 0 && i + directions[z][0] < SIZE
+			&& j + directions[z][1] >= 0 && j + directions[z][1] < SIZE) {
+			mask |= squareBit(squareIndex(i, j));
+			i += directions[z][0];
+			j += directions[z][1];
+		}
 	}
+	return mask;
+}
 
-	/*
-		In case of Knight.
-		The Knight can move in special movement that combines straight and diagonal steps,
-		two and one or one and two in each direction.
-		In order to locate the Knight, there is frame of squares, which include only the optional
-		locations that the Knight can arrive from them to the requested destination.
-		There are 2D array 5x5 which include the surrounding environment to the destination.
-		And the cases which are checked are only in the relevant frame of squares.
-	*/
-	case 'N': {
+/*************************************************************************************************
+*	Function name: randomMagic
+*	Input: Bitboard* seed
+*	Output: Bitboard
+*	Function Operation: this function returns random number with few bits set, which is good
+*	candidate for magic multiplier. the random generator is xorshift, so the magics which are
+*	found are the same in any run.
+***************************************************************************************************/
+Bitboard randomMagic(Bitboard* seed) {
 
-		Move knightMove = move;
+	Bitboard candidate = ~0ULL;
 
-		// Variable which holds the char which represents Knight by color turn
-		char knightChar = convertPieceChar(move);
+	//And of three random numbers leaves about eighth of the bits
+	for (int z = 0; z < 3; z++) {
+		*seed ^= *seed >> 12;
+		*seed ^= *seed << 25;
+		*seed ^= *seed >> 27;
+		candidate &= *seed * 2685821657736338717ULL;
+	}
+	return candidate;
+}
 
-		/*
-			Variables which holds the values of the left corner in the relevant frame of squares
-			according the surrounding environment to the destination.
-		*/
-		int rowIndex = move.iDest - 2;
-		int colIndex = move.jDest - 2;
-
-		// For loop which run on 2D array which represents surrounding environment
-		for (int i = rowIndex; i <= rowIndex + 4; i++) {
-			for (int j = colIndex; j <= colIndex + 4; j++)
-			{
-				//this is check that the indexs are not beyond the scope of board
-				if (i >= 0 && i < SIZE && j >= 0 && j < SIZE)
-				{
-					// If block in order to check only the rows in frame of squares which relevant
-					if (i == rowIndex || i == rowIndex + 4)
-					{
-						/*
-						If there is square with Knight, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-						*/
-						if (board[i][j] == knightChar)
-						{
-							knightMove = checkKnightMove(board, move, i, j);
-							if (knightMove.isLegal) {
-								knightMove.iSrc = i;
-								knightMove.jSrc = j;
-								if ((advRowSrc >= 0 && knightMove.iSrc != advRowSrc) || (advColSrc >= 0 && knightMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return knightMove;
-							}
-						}
-					}
-					// If block in order to check only the left columns in frame of squares which relevant
-					else if (i != rowIndex && j == colIndex) {
-
-						/*
-						If there is square with Knight, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-						*/
-						if (board[i][j] == knightChar)
-						{
-							knightMove = checkKnightMove(board, move, i, j);
-							if (knightMove.isLegal) {
-								knightMove.iSrc = i;
-								knightMove.jSrc = j;
-								if ((advRowSrc >= 0 && knightMove.iSrc != advRowSrc) || (advColSrc >= 0 && knightMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return knightMove;
-							}
-						}
-					}
-					// If block in order to check only the right columns in frame of squares which relevant
-					else if (i != rowIndex && j == colIndex + 4) {
-
-						/*
-						If there is square with Knight, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-						*/
-						if (board[i][j] == knightChar)
-						{
-							knightMove = checkKnightMove(board, move, i, j);
-							if (knightMove.isLegal) {
-								knightMove.iSrc = i;
-								knightMove.jSrc = j;
-								if ((advRowSrc >= 0 && knightMove.iSrc != advRowSrc) || (advColSrc >= 0 && knightMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return knightMove;
-							}
-						}
-					}
-				}
-			}
+/*************************************************************************************************
+*	Function name: initSlidingEntry
+*	Input: SlidingEntry* entry, int square, const int directions[][2], Bitboard knownMagic,
+*	Bitboard* table, Bitboard* seed
+*	Output: int (number of table entries which are used)
+*	Function Operation: this function fills the attacks table of sliding piece on square.
+*	(1) the relevant occupancy mask is computed and any subset of it is enumerated with its
+*		attacks, which are computed by walking on the rays by rayAttacks().
+*	(2) in case of PEXT, the index of any subset is the extracted bits of the subset, so the table
+*		is filled directly.
+*	(3) otherwise, the known magic (if exists) and then random magics are tried until the
+*		multiplication of any subset by the magic maps it to index which holds no different
+*		attacks (constructive collisions are allowed).
+***************************************************************************************************/
+int initSlidingEntry(SlidingEntry* entry, int square, const int directions[][2], Bitboard knownMagic, Bitboard* table, Bitboard* seed) {
+
+	Bitboard occupancies[1 << MAX_SLIDING_BITS];
+	Bitboard attacks[1 << MAX_SLIDING_BITS];
+	int epochs[1 << MAX_SLIDING_BITS];
+	int subsets = 0;
+
+	entry->mask = relevantOccupancy(square, directions);
+	entry->shift = 64 - countSquares(entry->mask);
+	entry->attacks = table;
+	entry->magic = 0;
+
+	//Enumeration of all the subsets of the mask by carry-rippler
+	Bitboard subset = 0;
+	do {
+		occupancies[subsets] = subset;
+		attacks[subsets] = rayAttacks(square, subset, directions, 4);
+		subsets++;
+		subset = (subset - entry->mask) & entry->mask;
+	} while (subset);
+
+	if (usePext) {
+		for (int z = 0; z < subsets; z++) {
+			table[slidingIndex(entry, occupancies[z])] = attacks[z];
 		}
-
-		// In case no legal move detected, change knightMove.isLegal to 0 and return
-		knightMove.isLegal = 0;
-		return knightMove;
+		return subsets;
 	}
 
-	/*
-		In case of Bishop.
-		The Bishop can move diagonally.
-		There are two nested loops which pass on any square in order to locate Bishop pieces.
-		In order to check if the optional piece which founded is relevant to Bishop movement,
-		So we use in fabs() function. Check whether the difference between the source row and
-		the destination row at absolute value equals the difference between the source column
-		and the destination column.
-	*/
-	case 'B': {
-
-
-		Move bishopMove = move;
-
-		// Variable which holds the char which represents Bishop by color turn
-		char bishopChar = convertPieceChar(move);
-
-		//Two nested loops which pass on any square in order to locate Bishop
-		for (int i = 0; i < SIZE; i++) {
-			for (int j = 0; j < SIZE; j++) {
-
-				/*
-					If there is square with Bishop, send the optinal move to sub-function to check if legal.
-					if this is legal Move, so the source row and column are defined.
-					In case of two optional pieces were detected, there is advance information about the source row or column.
-					So there is check if there is match between the row and column which founded.
-				*/
-				if (board[i][j] == bishopChar)
-				{
-					//Checking if move diagonally by absolute values
-					int isDiagonal = fabs(i - move.iDest) == fabs(j - move.jDest);
-					if (isDiagonal) {
-						bishopMove = checkBishopMove(board, move, i, j);
-						if (bishopMove.isLegal) {
-							bishopMove.iSrc = i;
-							bishopMove.jSrc = j;
-							if ((advRowSrc >= 0 && bishopMove.iSrc != advRowSrc) || (advColSrc >= 0 && bishopMove.jSrc != advColSrc)) {
-								continue;
-							}
-							return bishopMove;
-						}
-					}
-				}
+	memset(epochs, 0, sizeof(int) * subsets);
+	for (int epoch = 1;; epoch++) {
+
+		// The known magic is tried first. random magic which doesn't spread the mask to the high bits can't be good
+		if (epoch == 1 && knownMagic) {
+			entry->magic = knownMagic;
+		}
+		else {
+			entry->magic = randomMagic(seed);
+			if (countSquares((entry->mask * entry->magic) >> 56) < 6 && SQUARES == 64) {
+				continue;
 			}
 		}
-		// In case no legal move detected, change bishopMove.isLegal to 0 and return
-		bishopMove.isLegal = 0;
-		return bishopMove;
-	}
 
-	/*
-		In case of Queen.
-		The Queen can move in any straight line. Column, row or diagonal.
-		In case of row or column: There are two loops - one for rows and one for columns, with several
-		iterations according to board SIZE value.
-		In case of digonal:
-		There are two nested loops which pass on any square.
-		In order to check if the optional piece which founded is relevant to Queen diagonal movement,
-		So we use in fabs() function. Check whether the difference between the source row and
-		the destination row at absolute value equals the difference between the source column
-		and the destination column.
-	*/
-	case 'Q': {
-
-		Move queenMove = move;
-
-		// Variable which holds the char which represents Bishop by color turn
-		char queenChar = convertPieceChar(move);
-
-
-		//Two nested loops which pass on any square in order to locate Queen
-		for (int i = 0; i < SIZE; i++) {
-			for (int j = 0; j < SIZE; j++) {
-
-
-				/*
-				If there is square with Queen, send the optinal move to sub-function to check if legal.
-				if this is legal Move, so the source row and column are defined.
-				In case of two optional pieces were detected, there is advance information about the source row or column.
-				So there is check if there is match between the row and column which founded.
-				*/
-				if (board[i][j] == queenChar)
-				{
-					//If block to check column movement - check different rows and the column is constant
-					if (j == move.jDest && i != move.iDest) {
-						queenMove = checkQueenMove(board, move, i, move.jDest);
-						if (queenMove.isLegal) {
-							queenMove.iSrc = i;
-							queenMove.jSrc = move.jDest;
-							if ((advRowSrc >= 0 && queenMove.iSrc != advRowSrc) || (advColSrc >= 0 && queenMove.jSrc != advColSrc)) {
-								continue;
-							}
-							return queenMove;
-						}
-					}
-					//If block to check row movement - check different columns and the row is constant
-					else if (i == move.iDest && j != move.jDest) {
-						queenMove = checkQueenMove(board, move, move.iDest, j);
-						if (queenMove.isLegal) {
-							queenMove.iSrc = move.iDest;
-							queenMove.jSrc = j;
-							if ((advRowSrc >= 0 && queenMove.iSrc != advRowSrc) || (advColSrc >= 0 && queenMove.jSrc != advColSrc)) {
-								continue;
-							}
-							return queenMove;
-						}
-					}
-					else {
-						//Checking if move diagonally by absolute value
-						int isDiagonal = fabs(i - move.iDest) == fabs(j - move.jDest);
-						if (isDiagonal) {
-							queenMove = checkQueenMove(board, move, i, j);
-							if (queenMove.isLegal) {
-								queenMove.iSrc = i;
-								queenMove.jSrc = j;
-								if ((advRowSrc >= 0 && queenMove.iSrc != advRowSrc) || (advColSrc >= 0 && queenMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return queenMove;
-							}
-						}
-					}
-				}
+		int z;
+		for (z = 0; z < subsets; z++) {
+			unsigned int index = slidingIndex(entry, occupancies[z]);
+			if (epochs[index] < epoch) {
+				epochs[index] = epoch;
+				table[index] = attacks[z];
+			}
+			else if (table[index] != attacks[z]) {
+				break;
 			}
 		}
-		// In case no legal move detected, change queenMove.isLegal to 0 and return
-		queenMove.isLegal = 0;
-		return queenMove;
+		if (z == subsets) {
+			return subsets;
+		}
 	}
+}
 
-	/*
-		In case of King.
-		The King can move one square anywhere in any direction.
-		In order to locate the King, there is frame of squares, which include only the optional
-		locations that the King can arrive from them to the requested destination.
-		There are 2D array 3x3 which include the surrounding environment to the destination.
-		And the cases which are checked are only in the relevant frame of squares.
-	*/
-	case 'K': {
-
-		Move kingMove = move;
-
-		// Variable which holds the char which represents King by color turn
-		char kingChar = convertPieceChar(move);
-
-		/*
-			Variables which holds the values of the left corner in the relevant frame of squares
-			according the surrounding environment to the destination.
-		*/
-		int rowIndex = move.iDest - 1;
-		int colIndex = move.jDest - 1;
-
-		// For loop which run on 2D array which represents surrounding environment
-		for (int i = rowIndex; i <= rowIndex + 2; i++) {
-			for (int j = colIndex; j <= colIndex + 2; j++) {
-
-				//this is check that the indexs are not beyond the scope of board
-				if (i >= 0 && i < SIZE && j >= 0 && j < SIZE) {
-
-					/*
-						If there is square with King, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-					*/
-					if (board[i][j] == kingChar) {
-						kingMove = checkKingMove(board, move, i, j);
-						if (kingMove.isLegal) {
-							kingMove.iSrc = i;
-							kingMove.jSrc = j;
-							if ((advRowSrc >= 0 && kingMove.iSrc != advRowSrc) || (advColSrc >= 0 && kingMove.jSrc != advColSrc)) {
-								continue;
-							}
-							return kingMove;
-						}
-					}
-				}
-			}
-		}
-		// In case no legal move detected, change kingMove.isLegal to 0 and return
-		kingMove.isLegal = 0;
-		return kingMove;
-	}
+/*************************************************************************************************
+*	Function name: initSlidingTables
+*	Input: None
+*	Output: None
+*	Function Operation: this function initializes the attacks tables of Rook and Bishop for all
+*	squares. in case that the CPU supports BMI2 instructions, the tables are indexed by PEXT,
+*	otherwise by magic multiplication. it is called once by initChessTables().
+***************************************************************************************************/
+void initSlidingTables() {
 
-	/*
-		In case of Pawn.
-		Pawn can only move one square at a time and only one way. In his first move on
-		the second line, and only during that, he can move two squares forward or one square.
-		Pawn can only move "forward", the opposite direction to the board where it starts.
-		So there is two case of movements according to color turn.
-		In order to locate the Pawn, there is frame of squares, which include only the optional
-		locations that the Pawn can arrive from them to the requested destination.
-		There are 2D array 2x3 which include the surrounding environment to the destination.
-		And the cases which are checked are only in the relevant frame of squares.
-	*/
-	case 'P': {
-
-		Move pawnMove = move;
-
-		// Variable which holds the char which represents Pawn by color turn
-		char pawnChar = convertPieceChar(move);
-
-		// In case of white turn - forward means from top to bottom
-		if (move.isWhite) {
-
-			/*
-			Variables which holds the values of the left corner in the relevant frame of squares
-			according the surrounding environment to the destination.
-			*/
-			int rowIndex = move.iDest + 1;
-			int colIndex = move.jDest - 1;
-
-			// For loop which run on 2D array which represents surrounding environment
-			for (int i = rowIndex; i <= rowIndex + 1; i++) {
-				for (int j = colIndex; j <= colIndex + 2; j++) {
-
-					//this is check that the indexs are not beyond the scope of board
-					if (i >= 0 && i < SIZE && j >= 0 && j < SIZE) {
-
-						/*
-						If there is square with Pawn, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-						*/
-						if (board[i][j] == pawnChar) {
-							pawnMove = checkPawnMove(board, move, i, j);
-							if (pawnMove.isLegal) {
-								pawnMove.iSrc = i;
-								pawnMove.jSrc = j;
-								if ((advRowSrc >= 0 && pawnMove.iSrc != advRowSrc) || (advColSrc >= 0 && pawnMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return pawnMove;
-							}
-						}
-					}
-				}
-			}
+	Bitboard seed = 0x9E3779B97F4A7C15ULL;
+	int rookOffset = 0;
+	int bishopOffset = 0;
 
-		}
+#if PEXT_SUPPORT
+	usePext = __builtin_cpu_supports("bmi2") != 0;
+#endif
 
-		// In case of black turn - forward means from bottom to top
-		else {
+	for (int square = 0; square < SQUARES; square++) {
+		rookOffset += initSlidingEntry(&rookEntries[square], square, ROOK_DIRECTIONS, ROOK_MAGICS[square],
+			rookTable + rookOffset, &seed);
+		bishopOffset += initSlidingEntry(&bishopEntries[square], square, BISHOP_DIRECTIONS, BISHOP_MAGICS[square],
+			bishopTable + bishopOffset, &seed);
+	}
+}
 
-			/*
-				Variables which holds the values of the left corner in the relevant frame of squares
-				according the surrounding environment to the destination.
-			*/
-			int rowIndex = move.iDest - 2;
-			int colIndex = move.jDest - 1;
-
-			// For loop which run on 2D array which represents surrounding environment
-			for (int i = rowIndex; i <= rowIndex + 1; i++) {
-				for (int j = colIndex; j <= colIndex + 2; j++) {
-
-					//this is check that the indexs are not beyond the scope of board
-					if (i >= 0 && i < SIZE && j >= 0 && j < SIZE) {
-
-						/*
-						If there is square with Pawn, send the optinal move to sub-function to check if legal.
-						if this is legal Move, so the source row and column are defined.
-						In case of two optional pieces were detected, there is advance information about the source row or column.
-						So there is check if there is match between the row and column which founded.
-						*/
-						if (board[i][j] == pawnChar) {
-							pawnMove = checkPawnMove(board, move, i, j);
-							if (pawnMove.isLegal) {
-								pawnMove.iSrc = i;
-								pawnMove.jSrc = j;
-								if ((advRowSrc >= 0 && pawnMove.iSrc != advRowSrc) || (advColSrc >= 0 && pawnMove.jSrc != advColSrc)) {
-									continue;
-								}
-								return pawnMove;
-							}
-						}
-					}
-				}
-			}
-		}
+/*************************************************************************************************
+*	Function name: initChessTables
+*	Input: None
+*	Output: None
+*	Function Operation: this function fills all the tables of game: the sliding attacks, the line
+*	tables, the castling moves, the Zobrist keys, the SAN chars and the piece-square tables. the
+*	castling moves are taken from the line tables, so the order is kept. it is called once by
+*	initChessGame().
+***************************************************************************************************/
+void initChessTables() {
+	initSlidingTables();
+	initLineSquares();
+	initCastlingMoves();
+	initZobristKeys();
+	initSanChars();
+	initPieceSquareTables();
+}
 
-		// In case no legal move detected, change pawnMove.isLegal to 0 and return
-		pawnMove.isLegal = 0;
-		return pawnMove;
-	}
+/*************************************************************************************************
+*	Function name: initChessGame
+*	Input: None
+*	Output: None
+*	Function Operation: this function is the single entry point of the initialization. it is called
+*	before any position is created or any SAN is parsed, and fills the tables by initChessTables()
+*	only in the first call. with threads support the first call is guarded by call_once(), so
+*	positions may be created by several threads together.
+***************************************************************************************************/
+void initChessGame() {
+#if THREADS_SUPPORT
+	static once_flag isInitialized = ONCE_FLAG_INIT;
+	call_once(&isInitialized, initChessTables);
+#else
+	static int isInitialized = 0;
+	if (!isInitialized) {
+		initChessTables();
+		isInitialized = 1;
 	}
+#endif
+}
 
-	//In any case that no case chosen, change move.isLegal to 0 and return
-	move.isLegal = 0;
-	return move;
+/*************************************************************************************************
+*	Function name: randomKey
+*	Input: HashKey* seed
+*	Output: HashKey
+*	Function Operation: this function returns the next random key of splitmix64 generator, whose
+*	state is seed. the keys are the same in any run, so the Zobrist keys are stable.
+***************************************************************************************************/
+HashKey randomKey(HashKey* seed) {
 
+	HashKey key = (*seed += 0x9E3779B97F4A7C15ULL);
 
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
 }
 
 /*************************************************************************************************
-*	Function name: checkRookMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of Rook piece is legal according to its rules. such as: clear way to destination, type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: initZobristKeys
+*	Input: None
+*	Output: None
+*	Function Operation: this function fills the Zobrist keys of any piece code on any square, the
+*	key of black turn, the keys of en passant columns and the keys of the castling rights. any
+*	right has random key, and the key of rights is the XOR of the keys of its bits, so the key of
+*	rights can be replaced by single XOR. it is called once by initChessTables().
 ***************************************************************************************************/
-Move checkRookMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
-
+void initZobristKeys() {
 
-	/*
-		Clear way test:
-		The Rook can move in straight lines along the columns or rows.
-		So we need to check in any row and column between source to destination
-		if there is piece which block the requested move.
-		if the way is not clear, change move.isLegal to 0 and return.
-	*/
-
-	/*
-		Checking clear way on row.
-		In order to define the loop parameters, we check the value of destination row index
-		and source row index.
-	*/
-	if (move.iDest == iOptSrc) {
-		if (jOptSrc > move.jDest) {
-			for (int j = move.jDest + 1; j < jOptSrc; j++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (j >= 0 && j < SIZE) {
-					if (board[move.iDest][j] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
-		}
-		else {
-			for (int j = jOptSrc + 1; j < move.jDest; j++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (j >= 0 && j < SIZE) {
-					if (board[move.iDest][j] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
+	HashKey seed = 0x5A0B5157ULL;
+	HashKey rightKeys[CASTLING_MOVES];
 
+	for (int pieceCode = 0; pieceCode < NO_PIECE; pieceCode++) {
+		for (int square = 0; square < SQUARES; square++) {
+			zobristPieces[pieceCode][square] = randomKey(&seed);
 		}
+	}
+	zobristBlackTurn = randomKey(&seed);
+	for (int j = 0; j < SIZE; j++) {
+		zobristEnPassant[j] = randomKey(&seed);
+	}
 
+	for (int z = 0; z < CASTLING_MOVES; z++) {
+		rightKeys[z] = randomKey(&seed);
 	}
-	/*
-	Checking clear way on column.
-	In order to define the loop parameters, we check the value of destination column index
-	and source column index.
-	*/
-	else if (move.jDest == jOptSrc) {
-		if (iOptSrc > move.iDest) {
-			for (int i = move.iDest + 1; i < iOptSrc; i++) {
-				if (i >= 0 && i < SIZE) {
-					if (board[i][move.jDest] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
+	for (int rights = 0; rights < 1 << CASTLING_MOVES; rights++) {
+		zobristCastling[rights] = 0;
+		for (int z = 0; z < CASTLING_MOVES; z++) {
+			if (rights & (1 << z)) {
+				zobristCastling[rights] ^= rightKeys[z];
 			}
 		}
-		else {
-			for (int i = iOptSrc + 1; i < move.iDest; i++) {
-				if (i >= 0 && i < SIZE) {
-					if (board[i][move.jDest] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
-
-		}
-
 	}
+}
 
-	/*
-		Movement test:
-		The Rook can move in straight lines along the columns or rows.
-		So in case the rows of source and destination are differnet and in case
-		the columns of source and destination are differnet. it means that the move
-		is ilegal and change move.isLegal to 0 and return.
-	*/
-	if (move.iDest != iOptSrc && move.jDest != jOptSrc) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: computePositionKey
+*	Input: Position* position
+*	Output: HashKey
+*	Function Operation: this function computes the Zobrist key of position from scratch, by the
+*	pieces of the mailbox, the turn, the castling rights and the en passant column. the key which
+*	is updated incrementally in position should always be equal to it.
+***************************************************************************************************/
+HashKey computePositionKey(Position* position) {
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+	HashKey key = (position->isWhiteTurn ? 0 : zobristBlackTurn) ^ zobristCastling[position->castlingRights];
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
+	if (position->enPassantSquare >= 0) {
+		key ^= zobristEnPassant[position->enPassantSquare % SIZE];
 	}
+	Bitboard occupied = position->allPieces;
 
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
+	while (occupied) {
+		int square = popLowestSquare(&occupied);
+		key ^= zobristPieces[position->mailbox[square]][square];
 	}
+	return key;
+}
 
-	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: boardKey
+*	Input: char board[][SIZE], int isWhiteTurn
+*	Output: HashKey
+*	Function Operation: this function returns the Zobrist key of 2D array board (as created by
+*	createBoard()) with the color of turn. it is the same key of the position which is loaded from
+*	the board by loadPosition() (with the castling rights of the placement), so boards and
+*	positions can be compared by their keys.
+***************************************************************************************************/
+HashKey boardKey(char board[][SIZE], int isWhiteTurn) {
 
-	return move;
+	Position position;
+
+	loadPosition(&position, board, isWhiteTurn);
+	return position.key;
 }
 
 /*************************************************************************************************
-*	Function name: checkKnightMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of Knight piece is legal according to his rules. such as: type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: slidingIndex
+*	Input: SlidingEntry* entry, Bitboard occupied
+*	Output: unsigned int index
+*	Function Operation: this function returns the index of the occupied squares in the attacks
+*	table of sliding entry. only the relevant occupancy of the entry is used. the index is
+*	computed by PEXT instruction if it is supported, otherwise by magic multiplication.
 ***************************************************************************************************/
-Move checkKnightMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
-
-	/*
-		Movement test:
-		The Knight can move in special movement that combines straight and diagonal steps,
-		two and one or one and two in each direction.
-		So we use in fabs() function. Check whether the difference between the source row and
-		the destination row at absolute value and the difference between the source column
-		and the destination column at absolute value are 2 and 1, according to Knight legal steps.
-		If the values are not match to his rules, change move.isLegal to 0 and return.
-	*/
-	int rowL = (fabs(move.iDest - iOptSrc) == 2 && fabs(move.jDest - jOptSrc) == 1);
-	int colL = (fabs(move.iDest - iOptSrc) == 1 && fabs(move.jDest - jOptSrc) == 2);
-	if (!rowL && !colL) {
-		move.isLegal = 0;
-		return move;
+unsigned int slidingIndex(SlidingEntry* entry, Bitboard occupied) {
+#if PEXT_SUPPORT
+	if (usePext) {
+		return (unsigned int)extractBits(occupied, entry->mask);
 	}
+#endif
+	return (unsigned int)(((occupied & entry->mask) * entry->magic) >> entry->shift);
+}
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+/*************************************************************************************************
+*	Function name: knightAttacks
+*	Input: int square
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which Knight attacks from square,
+*	by lookup in the precomputed KNIGHT_ATTACKS table.
+***************************************************************************************************/
+Bitboard knightAttacks(int square) {
+	return KNIGHT_ATTACKS[square];
+}
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: kingAttacks
+*	Input: int square
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which King attacks from square,
+*	by lookup in the precomputed KING_ATTACKS table.
+***************************************************************************************************/
+Bitboard kingAttacks(int square) {
+	return KING_ATTACKS[square];
+}
 
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: pawnAttacks
+*	Input: int color, int square
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which Pawn in color attacks from square.
+*	white Pawn moves from bottom to top (lower row index) and black Pawn from top to bottom.
+***************************************************************************************************/
+Bitboard pawnAttacks(int color, int square) {
+	return PAWN_ATTACKS[color][square];
+}
 
-	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: pawnPushes
+*	Input: int color, int square
+*	Output: Bitboard
+*	Function Operation: the function returns the square which Pawn in color pushes to from square
+*	in one step forward. if Pawn is on the edge line, there is no such square and 0 returned.
+***************************************************************************************************/
+Bitboard pawnPushes(int color, int square) {
+	return PAWN_PUSHES[color][square];
+}
 
-	return move;
+/*************************************************************************************************
+*	Function name: bishopAttacks
+*	Input: int square, Bitboard occupied
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which Bishop attacks from square,
+*	according to the occupied squares which may block its diagonal lines. the attacks are
+*	single lookup in the sliding attacks table of square.
+***************************************************************************************************/
+Bitboard bishopAttacks(int square, Bitboard occupied) {
+	SlidingEntry* entry = &bishopEntries[square];
+	return entry->attacks[slidingIndex(entry, occupied)];
+}
 
+/*************************************************************************************************
+*	Function name: rookAttacks
+*	Input: int square, Bitboard occupied
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which Rook attacks from square,
+*	according to the occupied squares which may block its straight lines. the attacks are
+*	single lookup in the sliding attacks table of square.
+***************************************************************************************************/
+Bitboard rookAttacks(int square, Bitboard occupied) {
+	SlidingEntry* entry = &rookEntries[square];
+	return entry->attacks[slidingIndex(entry, occupied)];
+}
 
+/*************************************************************************************************
+*	Function name: queenAttacks
+*	Input: int square, Bitboard occupied
+*	Output: Bitboard attacks
+*	Function Operation: the function returns the squares which Queen attacks from square.
+*	the Queen attacks are the Rook attacks and the Bishop attacks together.
+***************************************************************************************************/
+Bitboard queenAttacks(int square, Bitboard occupied) {
+	return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
 }
 
 /*************************************************************************************************
-*	Function name: checkBishopMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of Bishop piece is legal according to its rules. such as: clear way to destination, type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: initLineSquares
+*	Input: None
+*	Output: None
+*	Function Operation: this function initializes the tables of squares between any two squares
+*	and of the full line through any two squares, for squares on the same row, column or diagonal.
+*	the tables are computed from the sliding attacks on empty board, so they are initialized
+*	after the sliding attacks tables.
 ***************************************************************************************************/
-Move checkBishopMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
+void initLineSquares() {
 
-	/*
-		Movement test:
-		The Bishop can move diagonally.
-		So we use in fabs() function. Check whether the difference between the source row and
-		the destination row at absolute value equals the difference between the source column
-		and the destination column. if the values not equal it means that Move is ilegal
-		and change move.isLegal to 0 and return.
-	*/
-	int isDiagonal = fabs(iOptSrc - move.iDest) == fabs(jOptSrc - move.jDest);
-	if (!isDiagonal) {
-		move.isLegal = 0;
-		return move;
+	for (int a = 0; a < SQUARES; a++) {
+		for (int b = 0; b < SQUARES; b++) {
+
+			Bitboard bitA = squareBit(a);
+			Bitboard bitB = squareBit(b);
+
+			betweenSquares[a][b] = 0;
+			lineSquares[a][b] = 0;
+
+			if (a == b) {
+				continue;
+			}
+			if (rookAttacks(a, 0) & bitB) {
+				betweenSquares[a][b] = rookAttacks(a, bitB) & rookAttacks(b, bitA);
+				lineSquares[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | bitA | bitB;
+			}
+			else if (bishopAttacks(a, 0) & bitB) {
+				betweenSquares[a][b] = bishopAttacks(a, bitB) & bishopAttacks(b, bitA);
+				lineSquares[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | bitA | bitB;
+			}
+		}
 	}
+}
 
-	// Variable which holds the char which represents Bishop by color turn
-	char bishopChar = convertPieceChar(move);
+/*************************************************************************************************
+*	Function name: initCastlingMoves
+*	Input: None
+*	Output: None
+*	Function Operation: this function initializes the castling moves of both colors and the rights
+*	masks of the squares: King which leaves its initial square loses both rights of its color, and
+*	any move from or to Rook corner removes the right of this corner. the squares between the King
+*	and the Rook are taken from betweenSquares, so the function is called after initLineSquares().
+***************************************************************************************************/
+void initCastlingMoves() {
 
+	for (int square = 0; square < SQUARES; square++) {
+		castlingMasks[square] = (1 << CASTLING_MOVES) - 1;
+	}
 
-	/*
-		Clear way test:
-		The Bishop can move diagonally.
-		So we need to check in any diagonal line between source to destination
-		if there is piece which block the requested move.
-		We need to check diagonal lines in any direction: top right, top left, bottom right
-		and bottom left. So there are several cases according to source and destionation values.
-		if the way is not clear, change move.isLegal to 0 and return.
-	*/
+	for (int color = WHITE_COLOR; color <= BLACK_COLOR; color++) {
 
-	int row = iOptSrc;
-	int column = jOptSrc;
+		int row = color == WHITE_COLOR ? SIZE - 1 : 0;
+		int kingSrc = squareIndex(row, SIZE / 2);
 
-	// Check clear diagonal line in direction: top left
-	if (iOptSrc < move.iDest && jOptSrc < move.jDest) {
+		for (int side = 0; side < 2; side++) {
 
-		//While loop until run all on squares between source and destination
-		row++;
-		column++;
-		while (!(row == move.iDest) && !(column == move.jDest)) {
+			CastlingMove* castling = &castlingMoves[color * 2 + side];
+			int isKingSide = side == 0;
 
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
+			castling->kingSrc = kingSrc;
+			castling->rookSrc = squareIndex(row, isKingSide ? SIZE - 1 : 0);
+			castling->kingDest = squareIndex(row, isKingSide ? SIZE - 2 : 2);
+			castling->rookDest = squareIndex(row, isKingSide ? SIZE - 3 : 3);
+			castling->kingPath = betweenSquares[kingSrc][castling->kingDest] | squareBit(castling->kingDest);
+			castling->emptySquares = (betweenSquares[kingSrc][castling->rookSrc] | castling->kingPath
+				| squareBit(castling->rookDest)) & ~(squareBit(kingSrc) | squareBit(castling->rookSrc));
 
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-				row++;
-				column++;
-			}
-		}
-	}
-	// Check clear diagonal line in direction: bottom left
-	else if (iOptSrc > move.iDest && jOptSrc < move.jDest) {
-		row--;
-		column++;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
-
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row--;
-			column++;
+			castlingMasks[castling->rookSrc] &= ~(1 << (color * 2 + side));
+			castlingMasks[kingSrc] &= ~(1 << (color * 2 + side));
 		}
 	}
-	// Check clear diagonal line in direction: top right
-	else if (iOptSrc < move.iDest && jOptSrc > move.jDest) {
-		row++;
-		column--;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
+}
 
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row++;
-			column--;
-		}
-	}
-	// Check clear diagonal line in direction: bottom left
-	else if (iOptSrc > move.iDest&& jOptSrc > move.jDest) {
-		row--;
-		column--;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
+/*************************************************************************************************
+*	Function name: castlingIndex
+*	Input: EncodedMove move, int color
+*	Output: int (index in castlingMoves)
+*	Function Operation: this function returns the index of castling move of color in castlingMoves,
+*	according to the direction of the King move.
+***************************************************************************************************/
+int castlingIndex(EncodedMove move, int color) {
+	return color * 2 + (moveDest(move) < moveSrc(move));
+}
 
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row--;
-			column--;
+/*************************************************************************************************
+*	Function name: placementCastlingRights
+*	Input: Position* position
+*	Output: int (castling rights bits)
+*	Function Operation: this function returns the castling rights which are possible by the pieces
+*	placement of position - the rights whose King and Rook are on their initial squares.
+***************************************************************************************************/
+int placementCastlingRights(Position* position) {
+
+	int castlingRights = 0;
+
+	for (int z = 0; z < CASTLING_MOVES; z++) {
+		int color = z / 2;
+		if (position->mailbox[castlingMoves[z].kingSrc] == color * PIECE_TYPES + KING_TYPE
+			&& position->mailbox[castlingMoves[z].rookSrc] == color * PIECE_TYPES + ROOK_TYPE) {
+			castlingRights |= 1 << z;
 		}
 	}
+	return castlingRights;
+}
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+/*************************************************************************************************
+*	Function name: setCastlingRights
+*	Input: Position* position, int castlingRights
+*	Output: None
+*	Function Operation: this function replaces the castling rights of position, and replaces the
+*	key of the rights in the Zobrist key of position.
+***************************************************************************************************/
+void setCastlingRights(Position* position, int castlingRights) {
+	position->key ^= zobristCastling[position->castlingRights] ^ zobristCastling[castlingRights];
+	position->castlingRights = castlingRights;
+}
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
-	}
+/*************************************************************************************************
+*	Function name: isCastlingAvailable
+*	Input: Position* position, int index
+*	Output: int (0 or 1)
+*	Function Operation: this function checks if the side to move can castle by castling move of
+*	index: the right exists, the squares between the King and the Rook are empty, the King is not
+*	in check and no square which the King passes or arrives to is attacked. the attacks are found
+*	by attackersTo(), like the check tests of isCheckCase().
+***************************************************************************************************/
+int isCastlingAvailable(Position* position, int index) {
 
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
+	CastlingMove* castling = &castlingMoves[index];
+	int color = index / 2;
+
+	if (!(position->castlingRights & (1 << index)) || (color == WHITE_COLOR) != position->isWhiteTurn
+		|| (position->allPieces & castling->emptySquares) || position->checkers) {
+		return 0;
 	}
 
-	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
+	Bitboard path = castling->kingPath;
+	while (path) {
+		if (attackersTo(position, popLowestSquare(&path), !color, position->allPieces)) {
+			return 0;
+		}
 	}
+	return 1;
+}
 
-	return move;
+/*************************************************************************************************
+*	Function name: enPassantCapturedSquare
+*	Input: int src, int dest
+*	Output: int (square)
+*	Function Operation: this function returns the square of the Pawn which is captured by en passant
+*	capture from src to dest - the square on the source row and on the destination column.
+***************************************************************************************************/
+int enPassantCapturedSquare(int src, int dest) {
+	return squareIndex(src / SIZE, dest % SIZE);
 }
 
 /*************************************************************************************************
-*	Function name: checkQueenMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of Queen piece is legal according to its rules. such as: clear way to destination, type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: isEnPassantPossible
+*	Input: Position* position, int square
+*	Output: int (0 or 1)
+*	Function Operation: this function checks if en passant capture to square is possible for the
+*	side to move: the square is empty, Pawn of the opponent is in front of it (as after two steps
+*	move) and Pawn of the side to move attacks it. the King safety is not tested.
 ***************************************************************************************************/
-Move checkQueenMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
+int isEnPassantPossible(Position* position, int square) {
 
-	/*
-		Movement test:
-		The Queen can move in any straight line. Column, row or diagonal.
-		In case of row or column: we need to check in any row and column between source to destination
-		if there is piece which block the requested move.
-		In case of digonal: we use in fabs() function. Check whether the difference between the source
-		row and the destination row at absolute value equals the difference between the source column
-		and the destination column. if there both types of move not legal, change move.isLegal to 0 and return.
-	*/
-	int IllegalMovementCounter = 0;
-	if (move.iDest != iOptSrc && move.jDest != jOptSrc) {
-		IllegalMovementCounter++;
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	int pushed = square + (color == WHITE_COLOR ? SIZE : -SIZE);
+
+	if (pushed < 0 || pushed >= SQUARES || (position->allPieces & squareBit(square))
+		|| position->mailbox[pushed] != !color * PIECE_TYPES + PAWN_TYPE) {
+		return 0;
 	}
-	int isDiagonal = fabs(iOptSrc - move.iDest) == fabs(jOptSrc - move.jDest);
-	if (!isDiagonal) {
-		IllegalMovementCounter++;
+	return (pawnAttacks(!color, square) & position->pieces[color][PAWN_TYPE]) != 0;
+}
+
+/*************************************************************************************************
+*	Function name: setEnPassantSquare
+*	Input: Position* position, int square
+*	Output: None
+*	Function Operation: this function replaces the en passant square of position (-1 for none), and
+*	replaces the key of its column in the Zobrist key of position.
+***************************************************************************************************/
+void setEnPassantSquare(Position* position, int square) {
+	if (position->enPassantSquare >= 0) {
+		position->key ^= zobristEnPassant[position->enPassantSquare % SIZE];
 	}
-	if (IllegalMovementCounter == 2) {
-		move.isLegal = 0;
-		return move;
+	if (square >= 0) {
+		position->key ^= zobristEnPassant[square % SIZE];
 	}
+	position->enPassantSquare = square;
+}
 
-	// Variable which holds the char which represents Bishop by color turn
-	char queenChar = convertPieceChar(move);
+/*************************************************************************************************
+*	Function name: enPassantExposesKing
+*	Input: Position* position, int src, int dest
+*	Output: int (0 or 1)
+*	Function Operation: this function check if en passant capture from src to dest leaves the King
+*	of the side to move under capture threat. en passant removes two pieces from the source row,
+*	so the pins of the check state are not enough, and the attackers of the King are computed
+*	by attackersTo() with the occupancy after the capture, except the captured Pawn itself.
+*	the same test also tells if the capture prevents current check.
+*	If the King is threatened after the capture - return 1, otherwise return 0.
+***************************************************************************************************/
+int enPassantExposesKing(Position* position, int src, int dest) {
 
-	/*
-		Clear way test:
-		The Queen can move in any straight line. Column, row or diagonal.
-		So we need to check in any row and column between source to destination
-		if there is piece which block the requested move.
-		And we need to check in any diagonal line between source to destination
-		if there is piece which block the requested move.
-		We need to check diagonal lines in any direction: top right, top left, bottom right
-		and bottom left. So there are several cases according to source and destionation values.
-		if the way is not clear, change move.isLegal to 0 and return.
-	*/
+	int color = position->mailbox[src] / PIECE_TYPES;
+	int king = position->kingSquare[color];
+	Bitboard captured = squareBit(enPassantCapturedSquare(src, dest));
+	Bitboard occupied = (position->allPieces ^ squareBit(src) ^ captured) | squareBit(dest);
 
-	int row = iOptSrc;
-	int column = jOptSrc;
+	if (king < 0) {
+		return 0;
+	}
+	return (attackersTo(position, king, !color, occupied) & ~captured) != 0;
+}
 
-	/* Checking straight line block */
+/*************************************************************************************************
+*	Function name: attackersTo
+*	Input: Position* position, int square, int color, Bitboard occupied
+*	Output: Bitboard attackers
+*	Function Operation: this function returns all the pieces in color which attack the square.
+*	the attacks are computed from the square itself - the square attacked by Knight if Knight
+*	located in the Knight attacks from the square, and the same for any other piece type.
+*	Pawn attackers are found by the attacks of Pawn in the opposite color.
+***************************************************************************************************/
+Bitboard attackersTo(Position* position, int square, int color, Bitboard occupied) {
 
+	Bitboard* pieces = position->pieces[color];
+	Bitboard diagonalPieces = pieces[BISHOP_TYPE] | pieces[QUEEN_TYPE];
+	Bitboard straightPieces = pieces[ROOK_TYPE] | pieces[QUEEN_TYPE];
 
-	/*
-		Checking clear way on row.
-		In order to define the loop parameters, we check the value of destination row index
-		and source row index.
-	*/
-	if (move.iDest == iOptSrc) {
-		if (jOptSrc > move.jDest) {
-			for (int j = move.jDest + 1; j < jOptSrc; j++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (j >= 0 && j < SIZE) {
-					if (board[move.iDest][j] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
-		}
-		else {
-			for (int j = jOptSrc + 1; j < move.jDest; j++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (j >= 0 && j < SIZE) {
-					if (board[move.iDest][j] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
+	return (pawnAttacks(!color, square) & pieces[PAWN_TYPE])
+		| (knightAttacks(square) & pieces[KNIGHT_TYPE])
+		| (kingAttacks(square) & pieces[KING_TYPE])
+		| (bishopAttacks(square, occupied) & diagonalPieces)
+		| (rookAttacks(square, occupied) & straightPieces);
+}
 
-		}
+/*************************************************************************************************
+*	Function name: pinnedPieces
+*	Input: Position* position, int color
+*	Output: Bitboard pinned
+*	Function Operation: this function returns the pieces in color which are pinned to their king.
+*	the opponent sliding pieces which would attack the king on empty board are the optional
+*	pinners. if there is exactly one piece between the pinner and the king, and this piece is in
+*	the king color, it is pinned.
+***************************************************************************************************/
+Bitboard pinnedPieces(Position* position, int color) {
 
+	int king = position->kingSquare[color];
+	Bitboard* opponent = position->pieces[!color];
+	Bitboard pinned = 0;
+
+	if (king < 0) {
+		return 0;
 	}
-	/*
-	Checking clear way on column.
-	In order to define the loop parameters, we check the value of destination column index
-	and source column index.
-	*/
-	else if (move.jDest == jOptSrc) {
-		if (iOptSrc > move.iDest) {
-			for (int i = move.iDest + 1; i < iOptSrc; i++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (i >= 0 && i < SIZE) {
-					if (board[i][move.jDest] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
-		}
-		else {
-			for (int i = iOptSrc + 1; i < move.iDest; i++) {
-				//this is check that the indexs are not beyond the scope of board
-				if (i >= 0 && i < SIZE) {
-					if (board[i][move.jDest] != EMPTY) {
-						move.isLegal = 0;
-						return move;
-					}
-				}
-			}
 
+	Bitboard pinners = (rookAttacks(king, 0) & (opponent[ROOK_TYPE] | opponent[QUEEN_TYPE]))
+		| (bishopAttacks(king, 0) & (opponent[BISHOP_TYPE] | opponent[QUEEN_TYPE]));
+
+	while (pinners) {
+		Bitboard blockers = betweenSquares[king][popLowestSquare(&pinners)] & position->allPieces;
+		if (blockers && !(blockers & (blockers - 1))) {
+			pinned |= blockers & position->occupancy[color];
 		}
+	}
+	return pinned;
+}
+
+/*************************************************************************************************
+*	Function name: computeCheckState
+*	Input: Position* position
+*	Output: None
+*	Function Operation: this function computes from scratch the check state of the side to move:
+*	the opponent pieces which attack its king and its pinned pieces. this is used when position
+*	is created, afterwards the state is updated by updateCheckState().
+***************************************************************************************************/
+void computeCheckState(Position* position) {
+
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	int king = position->kingSquare[color];
 
+	position->checkers = 0;
+	if (king >= 0) {
+		position->checkers = attackersTo(position, king, !color, position->allPieces);
 	}
+	position->pinned = pinnedPieces(position, color);
+}
 
+/*************************************************************************************************
+*	Function name: updateCheckState
+*	Input: Position* position, int movedSquare
+*	Output: None
+*	Function Operation: this function updates the check state after the opponent moved piece to
+*	movedSquare and the turn passed. only two kinds of check are possible after single move:
+*	- direct check by the moved piece. Knight and Pawn checks are tested by one lookup from the king.
+*	- check by sliding piece, directly or discovered by the moved piece, which is found by the
+*	  sliding attacks from the king square.
+*	The pinned pieces are computed again from the king square.
+***************************************************************************************************/
+void updateCheckState(Position* position, int movedSquare) {
 
-	/* Checking diagonal line block */
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	int king = position->kingSquare[color];
+	Bitboard* opponent = position->pieces[!color];
+	int movedType = position->mailbox[movedSquare] % PIECE_TYPES;
 
-	// Check clear diagonal line in direction: top left
-	if (iOptSrc < move.iDest && jOptSrc < move.jDest) {
-		row++;
-		column++;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row++;
-			column++;
-		}
+	position->checkers = 0;
+	position->pinned = 0;
+	if (king < 0) {
+		return;
 	}
 
-	// Check clear diagonal line in direction: bottom left
-	else if (iOptSrc > move.iDest&& jOptSrc < move.jDest) {
-		row--;
-		column++;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row--;
-			column++;
-		}
-	}
-	// Check clear diagonal line in direction: top right
-	else if (iOptSrc < move.iDest && jOptSrc > move.jDest) {
-		row++;
-		column--;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row++;
-			column--;
-		}
-	}
-	// Check clear diagonal line in direction: bottom left
-	else if (iOptSrc > move.iDest&& jOptSrc > move.jDest) {
-		row--;
-		column--;
-		//While loop until run all on squares between source and destination
-		while (!(row == move.iDest) && !(column == move.jDest)) {
-			//this is check that the indexs are not beyond the scope of board
-			if (row >= 0 && row < SIZE && column >= 0 && column < SIZE) {
-				if (board[row][column] != EMPTY) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			row--;
-			column--;
-		}
+	// Direct check by the moved Knight or Pawn
+	if (movedType == KNIGHT_TYPE && (knightAttacks(king) & squareBit(movedSquare))) {
+		position->checkers |= squareBit(movedSquare);
+	}
+	else if (movedType == PAWN_TYPE && (pawnAttacks(color, king) & squareBit(movedSquare))) {
+		position->checkers |= squareBit(movedSquare);
 	}
 
+	// Direct or discovered check by sliding pieces
+	position->checkers |= (rookAttacks(king, position->allPieces) & (opponent[ROOK_TYPE] | opponent[QUEEN_TYPE]))
+		| (bishopAttacks(king, position->allPieces) & (opponent[BISHOP_TYPE] | opponent[QUEEN_TYPE]));
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+	position->pinned = pinnedPieces(position, color);
+}
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
-	}
 
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
+//initialize move by parsing PGN
+
+
+/*************************************************************************************************
+*	Function name: initMove
+*	Input: Position* position, const char pgn[], int length, Move* move
+*	Output: None
+*	Function Operation: this function initialize Struct Move according to PGN string which recived
+*	and according to the turn color of position. the PGN is the first length chars of pgn, which
+*	doesn't have to be NUL terminated, so move may be parsed in place in the input buffer. the PGN
+*	is parsed by parseSan() in one pass. Then, when the Move is initialized, function send the move
+*	to additional sub-function to check for optional piece which Meets Move conditions.
+*	The Move is filled in place, so it is not copied between the sub-functions.
+***************************************************************************************************/
+void initMove(Position* position, const char pgn[], int length, Move* move) {
+
+	// Default initialization as legal move which is not castling
+	move->isLegal = 1;
+	move->castling = -1;
+	move->isEnPassant = 0;
+	move->isStalemate = 0;
+
+	// Define the color of turn
+	if (position->isWhiteTurn) {
+		move->isWhite = 1;
+	}
+	else {
+		move->isWhite = 0;
 	}
 
 	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+		Define the source and destination locations, the source piece type and the conditions
+		such as capture, check, mate and promotion. PGN which is not SAN move can't be legal.
 	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
+	if (parseSan(pgn, length, move) != SAN_OK) {
+		move->isLegal = 0;
+		return;
 	}
 
-	return move;
+	// Define the piece type which exist in destination location
+	move->destPiece = findDestPiece(move->iDest, move->jDest, position);
 
+	// Send the initialized Move to check for optional piece which Meets Move conditions.
+	findOptionalPieceByMove(position, move);
 }
 
 /*************************************************************************************************
-*	Function name: checkKingMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of King piece is legal according to its rules. such as: type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: parseCastlingFromPgn
+*	Input: const char pgn[], int length, Move* move
+*	Output: int (0 or 1)
+*	Function Operation: this function checks if PGN is castling: "O-O" for King side or "O-O-O"
+*	for Queen side (zeros are accepted too), which may be followed only by check or mate sign.
+*	in case of castling, the castling move of the turn color is defined in Move, with the King
+*	squares as source and destination and the declared check or mate, and 1 return. otherwise 0
+*	return and Move is not changed.
 ***************************************************************************************************/
-Move checkKingMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
-
-	/*
-		Movement test:
-		The King can move one square anywhere in any direction.
-		So we use in fabs() function. Check whether the difference between the source row and
-		the destination row at absolute value and the difference between the source column
-		and the destination column at absolute value are 0 or 1, according to King legal steps.
-		If the values are not match to his rules, change move.isLegal to 0 and return.
-	*/
-	int rowCheck = (fabs(move.iDest - iOptSrc) == 0 || fabs(move.iDest - iOptSrc) == 1);
-	int colCheck = (fabs(move.jDest - jOptSrc) == 0 || fabs(move.jDest - jOptSrc) == 1);
-	if (!rowCheck || !colCheck) {
-		move.isLegal = 0;
-		return move;
-	}
+int parseCastlingFromPgn(const char pgn[], int length, Move* move) {
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+	int c = 0;
+	int marks = 0;
+	int signs = 0;
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
+	while (c < length && (pgn[c] == 'O' || pgn[c] == '0')) {
+		marks++;
+		c++;
+		if (c < length && pgn[c] == '-') {
+			c++;
+			if (c == length || (pgn[c] != 'O' && pgn[c] != '0')) {
+				return 0;
+			}
+		}
 	}
-
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
+	while (c < length && (pgn[c] == CHECK || pgn[c] == MATE)) {
+		signs |= pgn[c++] == MATE ? 2 : 1;
 	}
-
-	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
+	if ((marks != 2 && marks != 3) || c != length) {
+		return 0;
 	}
 
-	return move;
+	CastlingMove* castling;
+	move->castling = (move->isWhite ? WHITE_COLOR : BLACK_COLOR) * 2 + (marks == 3);
+	castling = &castlingMoves[move->castling];
+	move->srcPiece = KING;
+	move->iSrc = castling->kingSrc / SIZE;
+	move->jSrc = castling->kingSrc % SIZE;
+	move->iDest = castling->kingDest / SIZE;
+	move->jDest = castling->kingDest % SIZE;
+	move->isCapture = 0;
+	move->isPromotion = 0;
+	move->isCheck = (signs & 1) != 0;
+	move->isMate = (signs & 2) != 0;
+	return 1;
 }
 
 /*************************************************************************************************
-*	Function name: checkPawnMove
-*	Input: char board[][SIZE], Move move, int iOptSrc, int jOptSrc
-*	Output: Move move
-*	Function Operation: this function check several condition in order to check if optional move
-*	of Pawn piece is legal according to its rules. such as: clear way to destination, type of movement,
-*	capture declaration without trial, destination which same color piece already located,
-*	and capture trial without declaration. some of tests are using the optional source row and column
-*	whihc recived from findOptionalPieceByMove function.
+*	Function name: initSanChars
+*	Input: None
+*	Output: None
+*	Function Operation: this function fills the SAN chars table: the columns chars of board, the
+*	rows digits of board, the pieces chars and the signs of capture, promotion, check, mate and
+*	castling. any other char is SAN_OTHER. it is called once by initChessTables().
 ***************************************************************************************************/
-Move checkPawnMove(char board[][SIZE], Move move, int iOptSrc, int jOptSrc) {
+void initSanChars() {
 
-	/*
-		Movement test:
-		Pawn can only move one square at a time and only one way. In his first move on
-		the second line, and only during that, he can move two squares forward or one square.
-		Pawn can only move "forward", the opposite direction to the board where it starts.
-		So there is two case of movements according to color turn.
-		In addition, Pawn move in different way when it captured, it move diagonally.
-		Moreover, there is special move to Pawn. When it arrives to the edge line on board,
-		there is Promotion and type of piece is changed.
-	*/
+	memset(sanChars, SAN_OTHER, sizeof(sanChars));
 
+	// Row digit '1' is the last row of 2D array board
+	for (int z = 0; z < SIZE; z++) {
+		sanChars[(unsigned char)(FIRST_COL + z)] = SAN_COLUMN | z;
+		sanChars['1' + z] = SAN_ROW | (SIZE - 1 - z);
+	}
+	for (int type = PAWN_TYPE; type <= KING_TYPE; type++) {
+		sanChars[(unsigned char)PIECE_CHARS[type]] = SAN_PIECE | type;
+	}
+	sanChars[(unsigned char)CAPTURE] = SAN_CAPTURE;
+	sanChars[(unsigned char)PROMOTION] = SAN_PROMOTION;
+	sanChars[(unsigned char)CHECK] = SAN_CHECK;
+	sanChars[(unsigned char)MATE] = SAN_MATE;
+	sanChars['O'] = SAN_CASTLING;
+	sanChars['0'] = SAN_CASTLING;
+}
 
-	// In case of white turn - forward means from top to bottom
-	if (move.isWhite) {
+/*************************************************************************************************
+*	Function name: initPieceSquareTables
+*	Input: None
+*	Output: None
+*	Function Operation: this function fills the middlegame and endgame scores of any piece code on
+*	any square: the value of piece and the bonus of its square, positive for white and negative
+*	for black. black piece gets the bonus of the mirrored row, and square of board in other SIZE
+*	gets the bonus of the square in the same relative place on 8x8 board. it is called once by
+*	initChessTables().
+***************************************************************************************************/
+void initPieceSquareTables() {
 
-		//check if there is Promotion
-		if (move.iDest == 0) {
-			if (!move.isPromotion) {
-				move.isLegal = 0;
-				return move;
-			}
-		}
+	for (int square = 0; square < SQUARES; square++) {
+		int row = SIZE > 1 ? square / SIZE * 7 / (SIZE - 1) : 0;
+		int col = SIZE > 1 ? square % SIZE * 7 / (SIZE - 1) : 0;
 
-		//In case of no capture - only forward steps available
-		if (!move.isCapture)
-		{
-			//Checking forward movement - from top to bottom
-			if (move.iDest > iOptSrc || jOptSrc != move.jDest) {
-				move.isLegal = 0;
-				return move;
-			}
+		for (int type = PAWN_TYPE; type <= KING_TYPE; type++) {
+			for (int color = WHITE_COLOR; color <= BLACK_COLOR; color++) {
+				int index = (color == WHITE_COLOR ? row : 7 - row) * 8 + col;
+				int sign = color == WHITE_COLOR ? 1 : -1;
+				int endgameBonus = MIDDLEGAME_SQUARES[type][index];
 
-			//In case of second line, check if he try to move 2 steps or 1 steps
-			if (iOptSrc == SIZE - 2) {
-				if (iOptSrc - move.iDest > 2 || jOptSrc != move.jDest) {
-					move.isLegal = 0;
-					return move;
+				if (type == PAWN_TYPE) {
+					endgameBonus = ENDGAME_PAWN_SQUARES[index];
 				}
-			}
-			else {
-				//In any other line, check if he try to move 1 steps only
-				if (iOptSrc - move.iDest > 1 || jOptSrc != move.jDest) {
-					move.isLegal = 0;
-					return move;
+				else if (type == KING_TYPE) {
+					endgameBonus = ENDGAME_KING_SQUARES[index];
 				}
+				middlegameSquareScores[color * PIECE_TYPES + type][square] = sign * (MIDDLEGAME_VALUES[type] + MIDDLEGAME_SQUARES[type][index]);
+				endgameSquareScores[color * PIECE_TYPES + type][square] = sign * (ENDGAME_VALUES[type] + endgameBonus);
 			}
 		}
+	}
+}
 
-		else {
+/*************************************************************************************************
+*	Function name: parseSan
+*	Input: const char pgn[], int length, Move* move
+*	Output: int (SAN_OK or error code)
+*	Function Operation: the function parses SAN move of length chars, in one pass from left to
+*	right, and defines in Move the source piece, the source location (-1 if not written), the
+*	destination location and the conditions: capture, promotion, check and mate. the color of
+*	Move must be defined before, because castling is parsed by parseCastlingFromPgn().
+*	any char is classified by one lookup in sanChars table:
+*	(1) optional piece char, otherwise the move is of Pawn.
+*	(2) up to four column and row chars, with optional capture sign before the last two. the last
+*		column and row are the destination, and the chars before them are the written source
+*		column, row or both.
+*	(3) optional promotion sign and piece, and then check and mate signs only.
+***************************************************************************************************/
+int parseSan(const char pgn[], int length, Move* move) {
 
-			//In case of capture - only digonal steps available
-			int iDiag = (move.iDest == iOptSrc - 1);
-			int jDiag = (move.jDest == jOptSrc + 1 || move.jDest == jOptSrc - 1);
-			if (!iDiag || !jDiag) {
-				move.isLegal = 0;
-				return move;
-			}
-		}
+	unsigned char squares[4];
+	int count = 0;
+	int captureAt = -1;
+	int c = 0;
 
+	if (length <= 0) {
+		return SAN_EMPTY;
+	}
+	if (SAN_CLASS(sanChars[(unsigned char)pgn[0]]) == SAN_CASTLING) {
+		return parseCastlingFromPgn(pgn, length, move) ? SAN_OK : SAN_BAD_CASTLING;
 	}
 
-	// In case of black turn - forward means from bottom to top
-	else if (!move.isWhite) {
+	move->srcPiece = PAWN;
+	if (SAN_CLASS(sanChars[(unsigned char)pgn[0]]) == SAN_PIECE) {
+		move->srcPiece = pgn[c++];
+	}
+	else if (isupper((unsigned char)pgn[0])) {
+		return SAN_BAD_PIECE;
+	}
 
-		//Check if there is Promotion
-		if (move.iDest == SIZE - 1) {
-			if (!move.isPromotion) {
-				move.isLegal = 0;
-				return move;
+	// Columns and rows, the capture sign is kept by the count of the chars before it
+	for (; c < length; c++) {
+		unsigned char entry = sanChars[(unsigned char)pgn[c]];
+		if (SAN_CLASS(entry) == SAN_COLUMN || SAN_CLASS(entry) == SAN_ROW) {
+			if (count == 4) {
+				return SAN_BAD_SQUARE;
 			}
+			squares[count++] = entry;
 		}
-
-		//In case of no capture - only forward steps available
-		if (!move.isCapture)
-		{
-			//Checking forward movement - from bottom to top
-			if (move.iDest < iOptSrc) {
-				move.isLegal = 0;
-				return move;
-			}
-
-			//In case of second line, check if he try to move 2 steps or 1 steps
-			if (iOptSrc == 1) {
-				if (move.iDest - iOptSrc > 2 || jOptSrc != move.jDest) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
-			//In any other line, check if he try to move 1 steps only
-			else {
-				if (move.iDest - iOptSrc > 1 || jOptSrc != move.jDest) {
-					move.isLegal = 0;
-					return move;
-				}
-			}
+		else if (SAN_CLASS(entry) == SAN_CAPTURE && captureAt < 0) {
+			captureAt = count;
 		}
-
 		else {
-
-			//In case of capture - only digonal steps available
-			int iDiag = (move.iDest == iOptSrc + 1);
-			int jDiag = (move.jDest == jOptSrc + 1 || move.jDest == jOptSrc - 1);
-			if (!iDiag || !jDiag) {
-				move.isLegal = 0;
-				return move;
-			}
+			break;
 		}
 	}
 
-	/*
-		Clear way test:
-		In case that Pawm move 2 steps, there is option that there is piece which block it.
-		So we need to check in any row and column between source to destination
-		if there is piece which block the requested move.
-		if the way is not clear, change move.isLegal to 0 and return.
-	*/
-	if (move.isWhite) {
-		if (iOptSrc == SIZE - 2 && move.iDest == SIZE - 4) {
-			if (board[SIZE - 3][move.jDest] != EMPTY) {
-				move.isLegal = 0;
-				return move;
-			}
+	// The destination is column and row, and the source is column, row or column and row
+	if (count < 2 || SAN_CLASS(squares[count - 2]) != SAN_COLUMN || SAN_CLASS(squares[count - 1]) != SAN_ROW
+		|| (count == 4 && SAN_CLASS(squares[0]) != SAN_COLUMN) || (count == 4 && SAN_CLASS(squares[1]) != SAN_ROW)) {
+		return SAN_BAD_SQUARE;
+	}
+	if (captureAt >= 0 && captureAt != count - 2) {
+		return SAN_BAD_CAPTURE;
+	}
+	move->iSrc = -1;
+	move->jSrc = -1;
+	for (int z = 0; z < count - 2; z++) {
+		if (SAN_CLASS(squares[z]) == SAN_COLUMN) {
+			move->jSrc = SAN_VALUE(squares[z]);
+		}
+		else {
+			move->iSrc = SAN_VALUE(squares[z]);
 		}
 	}
-	else if (!move.isWhite) {
-		if (iOptSrc == 1 && move.iDest == 3) {
-			if (board[2][move.jDest] != EMPTY) {
-				move.isLegal = 0;
-				return move;
-			}
+	move->jDest = SAN_VALUE(squares[count - 2]);
+	move->iDest = SAN_VALUE(squares[count - 1]);
+	move->isCapture = captureAt >= 0;
+
+	// Promotion of Pawn to any piece except Pawn and King
+	move->isPromotion = 0;
+	if (c < length && SAN_CLASS(sanChars[(unsigned char)pgn[c]]) == SAN_PROMOTION) {
+		unsigned char entry = c + 1 < length ? sanChars[(unsigned char)pgn[c + 1]] : SAN_OTHER;
+		if (move->srcPiece != PAWN || SAN_CLASS(entry) != SAN_PIECE
+			|| SAN_VALUE(entry) < KNIGHT_TYPE || SAN_VALUE(entry) > QUEEN_TYPE) {
+			return SAN_BAD_PROMOTION;
 		}
+		move->isPromotion = 1;
+		move->promotionPiece = pgn[c + 1];
+		c += 2;
 	}
 
-	/*
-		noCaptureDestTest:
-		In case of capture declaration without trial, cause the destionation is empty.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
+	move->isCheck = 0;
+	move->isMate = 0;
+	for (; c < length; c++) {
+		if (SAN_CLASS(sanChars[(unsigned char)pgn[c]]) == SAN_CHECK) {
+			move->isCheck = 1;
+		}
+		else if (SAN_CLASS(sanChars[(unsigned char)pgn[c]]) == SAN_MATE) {
+			move->isMate = 1;
+		}
+		else {
+			return SAN_EXTRA_DATA;
+		}
+	}
+	return SAN_OK;
+}
 
-	*/
-	if (noCaptureDestTest(move.isCapture, move.destPiece)) {
-		move.isLegal = 0;
-		return move;
+/*************************************************************************************************
+*	Function name: sanErrorText
+*	Input: int error
+*	Output: const char* (description)
+*	Function Operation: the function returns description of SAN error code of parseSan().
+***************************************************************************************************/
+const char* sanErrorText(int error) {
+	switch (error) {
+	case SAN_OK:
+		return "valid SAN";
+	case SAN_EMPTY:
+		return "empty move";
+	case SAN_BAD_PIECE:
+		return "unknown piece";
+	case SAN_BAD_SQUARE:
+		return "bad source or destination square";
+	case SAN_BAD_CAPTURE:
+		return "capture sign not before destination";
+	case SAN_BAD_PROMOTION:
+		return "bad promotion";
+	case SAN_BAD_CASTLING:
+		return "bad castling";
+	case SAN_EXTRA_DATA:
+		return "extra data after move";
 	}
+	return "unknown error";
+}
 
-	/*
-		sameColorPieceTest:
-		In case of destination which same color piece already located.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (sameColorPieceTest(move.destPiece, move.isWhite)) {
-		move.isLegal = 0;
-		return move;
+/*************************************************************************************************
+*	Function name: benchmarkSanParsing
+*	Input: const char* moves[], int count, int iterations
+*	Output: None
+*	Function Operation: the function parses the count SAN moves by parseSan(), iterations times,
+*	and prints the nanoseconds per move and the number of moves which are not valid SAN.
+***************************************************************************************************/
+void benchmarkSanParsing(const char* moves[], int count, int iterations) {
+
+	Move move;
+	int* lengths = malloc(sizeof(int) * (count > 0 ? count : 1));
+	long checksum = 0;
+	int errors = 0;
+	double startTime;
+
+	if (lengths == NULL) {
+		return;
+	}
+	initChessGame();
+	for (int z = 0; z < count; z++) {
+		lengths[z] = (int)strlen(moves[z]);
 	}
 
-	/*
-		noCaptureDeclareTest:
-		In case of capture trial without declaration.
-		change move.isLegal to 0 and return.
-		Using sub-function, details about it near function implementation.
-	*/
-	if (noCaptureDeclareTest(move.destPiece, move.isWhite, move.isCapture)) {
-		move.isLegal = 0;
-		return move;
+	move.isWhite = 1;
+	startTime = currentSeconds();
+	for (int k = 0; k < iterations; k++) {
+		for (int z = 0; z < count; z++) {
+			int error = parseSan(moves[z], lengths[z], &move);
+			errors += error != SAN_OK;
+			checksum += move.iDest + move.jSrc;
+		}
 	}
+	double seconds = currentSeconds() - startTime;
 
-	return move;
+	printf("parseSan: %.1f ns/move, %d errors\n", seconds * 1e9 / ((double)iterations * count), errors / (iterations > 0 ? iterations : 1));
+	printf("Checksum: %ld\n", checksum);
+	free(lengths);
 }
 
+/*************************************************************************************************
+*	Function name: findDestPiece
+*	Input: int iDest, int jDest, Position* position
+*	Output: char destPiece
+*	Function Operation: this function find the destination piece in the position mailbox according
+*	to specific row and column which recieved.
+***************************************************************************************************/
+char findDestPiece(int iDest, int jDest, Position* position) {
+	char destPiece = pieceCharFromCode(position->mailbox[squareIndex(iDest, jDest)]);
+	return destPiece;
+}
 
 /*************************************************************************************************
-*	Function name: isWhiteDest
-*	Input: char destPiece
-*	Output: int (0 or 1)
-*	Function Operation: this function recieved the destination piece char from which was parsed from
-*	the board 2D array. if this is lower case so it means that this is black piece, and 0 return.
-*	if this is capital case so it means that this is white piece and 1 return.
+*	Function name: encodeAnnotatedMove
+*	Input: Move* move
+*	Output: EncodedMove
+*	Function Operation: this function returns the encoded move of Move which its source and
+*	destination are known, in order to perform it by doMove(). castling is encoded as the King
+*	move with castling flag, and en passant capture with en passant flag.
 ***************************************************************************************************/
-int isWhiteDest(char destPiece) {
-	if (destPiece >= 'a' && destPiece <= 'z') {
-		return 0;
+EncodedMove encodeAnnotatedMove(Move* move) {
+
+	EncodedMove encoded = encodeMove(squareIndex(move->iSrc, move->jSrc), squareIndex(move->iDest, move->jDest),
+		move->isPromotion ? pieceTypeFromChar(move->promotionPiece) : -1);
+
+	if (move->castling >= 0) {
+		encoded |= MOVE_CASTLING << 12;
 	}
-	if (destPiece >= 'A' && destPiece <= 'Z') {
-		return 1;
+	if (move->isEnPassant) {
+		encoded |= MOVE_EN_PASSANT << 12;
 	}
+	return encoded;
 }
 
+
+
+//Find optional source + tests
+
+
 /*************************************************************************************************
-*	Function name: sameColorPieceTest
-*	Input: char destPiece, int isWhite
-*	Output: int (0 or 1)
-*	Function Operation: this function checks if in destination square, there is piece in the same
-*	color of the player turn. this function will be used for checking legal move. By chess rules,
-*	piece with specific color type can't move and capture another piece with same color in destination.
-*	This function use sub-function isWhiteDest() which described above.
-*	If there is piece with same color in destination - retrun 1
-*	If there is no piece with same color in destination - retrun 0
+*	Function name: optionalSourceSquares
+*	Input: Position* position, Move* move, int type
+*	Output: Bitboard sources
+*	Function Operation: this function returns the squares from which piece in the given type can
+*	arrive to the destination of Move. the squares are computed as attacks from the destination
+*	itself, because any piece (except Pawn) attacks the same squares in both directions.
+*	Pawn sources are the squares behind the destination in push, or the squares that Pawn in the
+*	opposite color attacks from the destination in capture. Knight, King and Pawn sources are
+*	single lookups in the precomputed attack tables.
 ***************************************************************************************************/
-int sameColorPieceTest(char destPiece, int isWhite) {
+Bitboard optionalSourceSquares(Position* position, Move* move, int type) {
 
-	if (destPiece != EMPTY) {
+	int dest = squareIndex(move->iDest, move->jDest);
+	int color = move->isWhite ? WHITE_COLOR : BLACK_COLOR;
 
-		if (isWhite) {
-			if (isWhiteDest(destPiece)) {
-				return 1;
-			}
-			else {
-				return 0;
-			}
+	switch (type) {
+	case PAWN_TYPE: {
+		if (move->isCapture) {
+			return pawnAttacks(!color, dest);
 		}
-		else {
-			if (!isWhiteDest(destPiece)) {
-				return 1;
-			}
-			else {
+		/*
+			Push of one step or two steps. The square behind the destination is the push of Pawn
+			in the opposite color, and if this square is empty, Pawn may come from one square behind it.
+		*/
+		Bitboard sources = pawnPushes(!color, dest);
+		if (sources && !(sources & position->allPieces)) {
+			sources |= pawnPushes(!color, lowestSquare(sources));
+		}
+		return sources;
+	}
+	case KNIGHT_TYPE:
+		return knightAttacks(dest);
+	case BISHOP_TYPE:
+		return bishopAttacks(dest, position->allPieces);
+	case ROOK_TYPE:
+		return rookAttacks(dest, position->allPieces);
+	case QUEEN_TYPE:
+		return queenAttacks(dest, position->allPieces);
+	case KING_TYPE:
+		return kingAttacks(dest);
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: findOptionalPieceByMove
+*	Input: Position* position, Move* move
+*	Output: None
+*	Function Operation: this function recieved initialized Move and according to the type of source
+*	piece, try to find optional piece on board, which can make this Move.
+*	The optional pieces are the pieces of source type and turn color which located on the squares
+*	that can arrive to the requested destination (see optionalSourceSquares()). In case that
+*	advance source row or column were provided in PGN, the other squares are removed.
+*	Any optional piece is sent to sub-function which check if the move is legal according to piece type.
+***************************************************************************************************/
+void findOptionalPieceByMove(Position* position, Move* move) {
+
+	int type = pieceTypeFromChar(move->srcPiece);
+	int color = move->isWhite ? WHITE_COLOR : BLACK_COLOR;
+
+	// In case of unknown piece type, change move->isLegal to 0 and return
+	if (type < 0) {
+		move->isLegal = 0;
+		return;
+	}
+
+	// Castling has single optional King, which is tested by its own rules
+	if (move->castling >= 0) {
+		move->isLegal = checkCastlingMove(position, move);
+		return;
+	}
+
+	// Bitboard of the optional pieces which may arrive to destination
+	Bitboard candidates = position->pieces[color][type] & optionalSourceSquares(position, move, type);
+
+	/*
+		While loop on the optional pieces.
+		In case of two optional pieces were detected, there is advance information about the source row or column.
+		So there is check if there is match between the row and column which founded.
+		If there is legal Move, the source row and column are defined and the function return.
+	*/
+	while (candidates) {
+
+		int src = popLowestSquare(&candidates);
+		int iSrc = src / SIZE;
+		int jSrc = src % SIZE;
+
+		if ((move->iSrc >= 0 && iSrc != move->iSrc) || (move->jSrc >= 0 && jSrc != move->jSrc)) {
+			continue;
+		}
+
+		/*
+			Pinned piece which leaves the line of its pin can't make the move, so it is not optional
+			piece. it is skipped before the piece tests, so only the accepted piece marks the Move.
+		*/
+		int king = position->kingSquare[color];
+		if ((position->pinned & squareBit(src))
+			&& !(lineSquares[king][src] & squareBit(squareIndex(move->iDest, move->jDest)))) {
+			continue;
+		}
+
+		int isLegal = 0;
+
+		//Switch case according to source piece type
+		switch (type) {
+		case PAWN_TYPE:
+			isLegal = checkPawnMove(position, move, iSrc, jSrc);
+			break;
+		case KNIGHT_TYPE:
+			isLegal = checkKnightMove(move, iSrc, jSrc);
+			break;
+		case BISHOP_TYPE:
+			isLegal = checkBishopMove(position, move, iSrc, jSrc);
+			break;
+		case ROOK_TYPE:
+			isLegal = checkRookMove(position, move, iSrc, jSrc);
+			break;
+		case QUEEN_TYPE:
+			isLegal = checkQueenMove(position, move, iSrc, jSrc);
+			break;
+		case KING_TYPE:
+			isLegal = checkKingMove(move, iSrc, jSrc);
+			break;
+		}
+
+		if (isLegal) {
+			move->iSrc = iSrc;
+			move->jSrc = jSrc;
+			return;
+		}
+	}
+
+	// In case no legal move detected, change move->isLegal to 0
+	move->isLegal = 0;
+}
+
+/*************************************************************************************************
+*	Function name: checkCastlingMove
+*	Input: Position* position, Move* move
+*	Output: int (0 or 1)
+*	Function Operation: this function check if the castling move of Move is legal according to its
+*	rules: the castling right was not lost, the way between the King and the Rook is clear, and the
+*	King is not in check and doesn't pass through or arrive to attacked square (by
+*	isCastlingAvailable()). castling can't be declared as capture or promotion.
+***************************************************************************************************/
+int checkCastlingMove(Position* position, Move* move) {
+
+	if (move->isCapture || move->isPromotion) {
+		return 0;
+	}
+	return isCastlingAvailable(position, move->castling);
+}
+
+/*************************************************************************************************
+*	Function name: checkRookMove
+*	Input: Position* position, Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of Rook piece is legal according to its rules. such as: clear way to destination, type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkRookMove(Position* position, Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement and clear way test:
+		The Rook can move in straight lines along the columns or rows, until the first piece
+		which blocks the line. So the destination must be one of the squares which the Rook
+		attacks from source, according to the occupied squares on board.
+		if the destination is not attacked, return 0.
+	*/
+	Bitboard attacks = rookAttacks(squareIndex(iOptSrc, jOptSrc), position->allPieces);
+	if (!(attacks & squareBit(squareIndex(move->iDest, move->jDest)))) {
+		return 0;
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: checkKnightMove
+*	Input: Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of Knight piece is legal according to his rules. such as: type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkKnightMove(Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement test:
+		The Knight can move in special movement that combines straight and diagonal steps,
+		two and one or one and two in each direction.
+		So the destination must be one of the squares which the Knight attacks from source.
+		If the destination is not attacked, return 0.
+	*/
+	if (!(knightAttacks(squareIndex(iOptSrc, jOptSrc)) & squareBit(squareIndex(move->iDest, move->jDest)))) {
+		return 0;
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: checkBishopMove
+*	Input: Position* position, Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of Bishop piece is legal according to its rules. such as: clear way to destination, type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkBishopMove(Position* position, Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement and clear way test:
+		The Bishop can move diagonally, until the first piece which blocks the diagonal line.
+		So the destination must be one of the squares which the Bishop attacks from source,
+		according to the occupied squares on board.
+		if the destination is not attacked, return 0.
+	*/
+	Bitboard attacks = bishopAttacks(squareIndex(iOptSrc, jOptSrc), position->allPieces);
+	if (!(attacks & squareBit(squareIndex(move->iDest, move->jDest)))) {
+		return 0;
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: checkQueenMove
+*	Input: Position* position, Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of Queen piece is legal according to its rules. such as: clear way to destination, type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkQueenMove(Position* position, Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement and clear way test:
+		The Queen can move in any straight line. Column, row or diagonal, until the first piece
+		which blocks the line. So the destination must be one of the squares which the Queen
+		attacks from source.
+		if the destination is not attacked, return 0.
+	*/
+	Bitboard attacks = queenAttacks(squareIndex(iOptSrc, jOptSrc), position->allPieces);
+	if (!(attacks & squareBit(squareIndex(move->iDest, move->jDest)))) {
+		return 0;
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: checkKingMove
+*	Input: Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of King piece is legal according to its rules. such as: type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkKingMove(Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement test:
+		The King can move one square anywhere in any direction.
+		So the destination must be one of the squares which the King attacks from source.
+		If the destination is not attacked, return 0.
+	*/
+	if (!(kingAttacks(squareIndex(iOptSrc, jOptSrc)) & squareBit(squareIndex(move->iDest, move->jDest)))) {
+		return 0;
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: checkPawnMove
+*	Input: Position* position, Move* move, int iOptSrc, int jOptSrc
+*	Output: int (0 or 1)
+*	Function Operation: this function check several condition in order to check if optional move
+*	of Pawn piece is legal according to its rules. such as: clear way to destination, type of movement,
+*	capture declaration without trial, destination which same color piece already located,
+*	and capture trial without declaration. diagonal capture to the en passant square of position
+*	is en passant capture. some of tests are using the optional source row and column
+*	whihc recived from findOptionalPieceByMove function.
+***************************************************************************************************/
+int checkPawnMove(Position* position, Move* move, int iOptSrc, int jOptSrc) {
+
+	/*
+		Movement test:
+		Pawn can only move one square at a time and only one way. In his first move on
+		the second line, and only during that, he can move two squares forward or one square.
+		Pawn can only move "forward", the opposite direction to the board where it starts.
+		So there is two case of movements according to color turn.
+		In addition, Pawn move in different way when it captured, it move diagonally.
+		Moreover, there is special move to Pawn. When it arrives to the edge line on board,
+		there is Promotion and type of piece is changed.
+	*/
+	int color = move->isWhite ? WHITE_COLOR : BLACK_COLOR;
+	int src = squareIndex(iOptSrc, jOptSrc);
+	int dest = squareIndex(move->iDest, move->jDest);
+
+	// In case of white turn - forward means from bottom to top, otherwise from top to bottom
+	int forward = move->isWhite ? -1 : 1;
+	int secondLine = move->isWhite ? SIZE - 2 : 1;
+	int lastLine = move->isWhite ? 0 : SIZE - 1;
+
+	//Promotion must be declared on the edge line only, and only to Knight, Bishop, Rook or Queen
+	if ((move->iDest == lastLine) != (move->isPromotion != 0)) {
+		return 0;
+	}
+	if (move->isPromotion) {
+		int promotionType = pieceTypeFromChar(move->promotionPiece);
+		if (promotionType < KNIGHT_TYPE || promotionType > QUEEN_TYPE) {
+			return 0;
+		}
+	}
+
+	//In case of capture - only digonal steps available
+	if (move->isCapture) {
+		if (!(pawnAttacks(color, src) & squareBit(dest))) {
+			return 0;
+		}
+
+		/*
+			En passant test:
+			Capture to the empty en passant square captures the Pawn which passed it in the last
+			move, so the destination tests below don't apply to it.
+		*/
+		if (dest == position->enPassantSquare) {
+			move->isEnPassant = 1;
+			return 1;
+		}
+	}
+
+	//In case of no capture - only forward steps available
+	else {
+		if (jOptSrc != move->jDest) {
+			return 0;
+		}
+
+		/*
+			Clear way test:
+			In case of second line, Pawn may move 2 steps, if there is no piece which block it.
+			In any other case, Pawn may move 1 step only.
+		*/
+		int isOneStep = (move->iDest == iOptSrc + forward);
+		int isTwoSteps = (iOptSrc == secondLine && move->iDest == iOptSrc + 2 * forward
+			&& !(position->allPieces & squareBit(squareIndex(iOptSrc + forward, jOptSrc))));
+		if (!isOneStep && !isTwoSteps) {
+			return 0;
+		}
+	}
+
+	/*
+		noCaptureDestTest:
+		In case of capture declaration without trial, cause the destionation is empty.
+		return 0.
+		Using sub-function, details about it near function implementation.
+
+	*/
+	if (noCaptureDestTest(move->isCapture, move->destPiece)) {
+		return 0;
+	}
+
+	/*
+		sameColorPieceTest:
+		In case of destination which same color piece already located.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (sameColorPieceTest(move->destPiece, move->isWhite)) {
+		return 0;
+	}
+
+	/*
+		noCaptureDeclareTest:
+		In case of capture trial without declaration.
+		return 0.
+		Using sub-function, details about it near function implementation.
+	*/
+	if (noCaptureDeclareTest(move->destPiece, move->isWhite, move->isCapture)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+
+/*************************************************************************************************
+*	Function name: isWhiteDest
+*	Input: char destPiece
+*	Output: int (0 or 1)
+*	Function Operation: this function recieved the destination piece char from which was parsed from
+*	the board 2D array. if this is lower case so it means that this is black piece, and 0 return.
+*	if this is capital case so it means that this is white piece and 1 return. any other char (empty
+*	square) is not white piece, so 0 return.
+***************************************************************************************************/
+int isWhiteDest(char destPiece) {
+	if (destPiece >= 'a' && destPiece <= 'z') {
+		return 0;
+	}
+	if (destPiece >= 'A' && destPiece <= 'Z') {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: sameColorPieceTest
+*	Input: char destPiece, int isWhite
+*	Output: int (0 or 1)
+*	Function Operation: this function checks if in destination square, there is piece in the same
+*	color of the player turn. this function will be used for checking legal move-> By chess rules,
+*	piece with specific color type can't move and capture another piece with same color in destination.
+*	This function use sub-function isWhiteDest() which described above.
+*	If there is piece with same color in destination - retrun 1
+*	If there is no piece with same color in destination - retrun 0
+***************************************************************************************************/
+int sameColorPieceTest(char destPiece, int isWhite) {
+
+	if (destPiece != EMPTY) {
+
+		if (isWhite) {
+			if (isWhiteDest(destPiece)) {
+				return 1;
+			}
+			else {
+				return 0;
+			}
+		}
+		else {
+			if (!isWhiteDest(destPiece)) {
+				return 1;
+			}
+			else {
+				return 0;
+			}
+
+		}
+
+	}
+
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: noCaptureDestTest
+*	Input: int isCapture, char destPiece
+*	Output: int (0 or 1)
+*	Function Operation: this function recieved flag if there is capture declaration and the kind
+*	of piece which is located in destination. It may be that there is no piece in destination and it
+*	is empty. In this case, the Move is ilegal. cause there is declaration on capture but there is no
+*	piece in destination to be captured.
+*	If there is capture declarartion but there is no piece in dest - return 1
+*	else, if there is no capture declaration or there is piece in dest - return 0
+***************************************************************************************************/
+int noCaptureDestTest(int isCapture, char destPiece) {
+
+	if (isCapture && destPiece == EMPTY) {
+		return 1;
+	}
+	else {
+		return 0;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: noCaptureDeclareTest
+*	Input: char destPiece, int isWhite, int isCapture
+*	Output: int (0 or 1)
+*	Function Operation: this function recieved flag if there is capture declaration, the color of turn
+*	and the kind of piece which is located in destination. if the destination is not empty, and the
+*	piece in destination is different from turn color - so capture need to be declared.
+*	If there is no capture declaration - the move is ilegal.
+*	If there is capture trial without declaration - return 1
+*	Else if there is no capture or there is declaration - return 0
+***************************************************************************************************/
+int noCaptureDeclareTest(char destPiece, int isWhite, int isCapture) {
+
+	if (destPiece != EMPTY) {
+
+		if (isWhite) {
+			if (!isWhiteDest(destPiece) && !(isCapture)) {
+				return 1;
+			}
+			else {
+				return 0;
+			}
+		}
+		else {
+			if (isWhiteDest(destPiece) && !(isCapture)) {
+				return 1;
+			}
+			else {
+				return 0;
+			}
+
+		}
+
+	}
+
+	return 0;
+}
+
+
+// Check tests
+
+/*************************************************************************************************
+*	Function name: testCheckConditions
+*	Input: Position* position, Move* move
+*	Output: None
+*	Function Operation: this function gathers all the tests that need to be checked in check
+*	situation. this function use sub-functions which will be described below.
+*	The tests of the player King safety use the check state of the current position. Then, the move
+*	is performed once in place by doMove(), the check and mate declaration tests are done against
+*	the check state after the move and against hasLegalReply() of the opponent, and the move is
+*	undone by undoMove(). the same trial finds stalemate - no check and no legal reply - which is
+*	kept in move->isStalemate.
+*	Description about tests:
+*	-In case of perfroming move leads to check threat, change move->isLegal to 0 and return
+*	-In case of current check situation, that illegal move try to be done, change move->isLegal
+* 	to 0 and return.
+*	-In case of check trial without declaration, change move->isLegal to 0 and return
+*	-In case of check declaration without trial, change move->isLegal to 0 and return
+*	-In case of mate without mate declaration, or mate declaration without mate, change
+*	move->isLegal to 0 and return
+*	- In any other case, the move is not changed
+***************************************************************************************************/
+void testCheckConditions(Position* position, Move* move) {
+
+	UndoInfo undo;
+
+	if (moveCauseToCheckThreat(position, move)) {
+		move->isLegal = 0;
+		return;
+	}
+
+	if (limitedMoveInCheckCase(position, move)) {
+		move->isLegal = 0;
+		return;
+	}
+
+	// Single trial of the move, the opponent is the side to move in the trial position
+	doMove(position, encodeAnnotatedMove(move), &undo);
+	int isCheckAfterMove = position->checkers != 0;
+	int hasReply = hasLegalReply(position);
+	int isMateAfterMove = isCheckAfterMove && !hasReply;
+	move->isStalemate = !isCheckAfterMove && !hasReply;
+	undoMove(position, &undo);
+
+	if (checkTrialWithoutDeclare(move, isCheckAfterMove)) {
+		move->isLegal = 0;
+		return;
+	}
+
+	if (checkDeclareWithoutTrial(move, isCheckAfterMove)) {
+		move->isLegal = 0;
+		return;
+	}
+
+	if (mateTrialWithoutDeclare(move, isMateAfterMove)) {
+		move->isLegal = 0;
+		return;
+	}
+
+	if (mateDeclareWithoutTrial(move, isMateAfterMove)) {
+		move->isLegal = 0;
+		return;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: isCheckCase
+*	Input: Position* position, int isWhiteMove, int isTheratToWhite
+*	Output: int (0 or 1)
+*	Function Operation: this function receives the currnt position, flag for color of turn,
+*	and flag for color to the threatened side. This function if there is any piece on board
+*	that can make legal move and to capture the king. if there is Move which found, it means that there
+*	is threat to king and this is check situation. If this is check case, return 1. if there is not
+*	check case, return 0.
+*	In case that the threatened side is the side to move, the answer is already in the check state
+*	of position. otherwise, the threatening pieces are found by attackersTo() from the king square.
+***************************************************************************************************/
+int isCheckCase(Position* position, int isWhiteMove, int isTheratToWhite) {
+
+	int threatenedColor = isTheratToWhite ? WHITE_COLOR : BLACK_COLOR;
+	int attackerColor = isWhiteMove ? WHITE_COLOR : BLACK_COLOR;
+	int king = position->kingSquare[threatenedColor];
+
+	// In case that there is no king on board, there is no check case
+	if (king < 0 || attackerColor == threatenedColor) {
+		return 0;
+	}
+
+	if (isTheratToWhite == position->isWhiteTurn) {
+		return position->checkers != 0;
+	}
+
+	if (attackersTo(position, king, attackerColor, position->allPieces)) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: checkTrialWithoutDeclare
+*	Input: Move* move, int isCheckAfterMove
+*	Output: int (0 or 1)
+*	Function Operation: this function check if there is check trial without declaration.
+*	the flag isCheckAfterMove is the check state of the opponent in the trial of the move, which
+*	is done by testCheckConditions().
+*	If there is check trial without declaration - return 1
+*	If there is no check trial or there is declaration - return 0
+***************************************************************************************************/
+int checkTrialWithoutDeclare(Move* move, int isCheckAfterMove) {
+
+	if (!move->isCheck && !move->isMate && isCheckAfterMove) {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: checkDeclareWithoutTrial
+*	Input: Move* move, int isCheckAfterMove
+*	Output: int (0 or 1)
+*	Function Operation:  this function check if there is check declarattion without trial.
+*	the flag isCheckAfterMove is the check state of the opponent in the trial of the move, which
+*	is done by testCheckConditions().
+*	If there is check declaration without trial - return 1
+*	If there is no check declaration or there is check trial - return 0
+***************************************************************************************************/
+int checkDeclareWithoutTrial(Move* move, int isCheckAfterMove) {
+
+	if ((move->isCheck || move->isMate) && !isCheckAfterMove) {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: mateTrialWithoutDeclare
+*	Input: Move* move, int isMateAfterMove
+*	Output: int (0 or 1)
+*	Function Operation: this function check if the move mates without mate declaration (only
+*	check is declared). the flag isMateAfterMove is the mate state of the opponent in the trial of
+*	the move, which is done by testCheckConditions().
+*	If there is mate without declaration - return 1
+*	If there is no mate or there is declaration - return 0
+***************************************************************************************************/
+int mateTrialWithoutDeclare(Move* move, int isMateAfterMove) {
+
+	if (!move->isMate && isMateAfterMove) {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: mateDeclareWithoutTrial
+*	Input: Move* move, int isMateAfterMove
+*	Output: int (0 or 1)
+*	Function Operation: this function check if there is mate declaration on move which doesn't
+*	mate - the opponent is not in check, or it has legal reply by hasLegalReply().
+*	the flag isMateAfterMove is the mate state of the opponent in the trial of the move, which
+*	is done by testCheckConditions().
+*	If there is mate declaration without mate - return 1
+*	If there is no mate declaration or there is mate - return 0
+***************************************************************************************************/
+int mateDeclareWithoutTrial(Move* move, int isMateAfterMove) {
+
+	if (move->isMate && !isMateAfterMove) {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: moveExposesKing
+*	Input: Position* position, int src, int dest
+*	Output: int (0 or 1)
+*	Function Operation: this function check if moving the piece on src to dest leaves its King
+*	under capture threat. The test uses the check state of position, without performing the move:
+*	- King can't move to square which is attacked by opponent. the attacks are computed without
+*	  the King itself, because it can't hide behind itself from sliding piece.
+*	- Pinned piece can move only on the line between its King and the pinning piece.
+*	If the move exposes the King - return 1, otherwise return 0.
+***************************************************************************************************/
+int moveExposesKing(Position* position, int src, int dest) {
+
+	int color = position->mailbox[src] / PIECE_TYPES;
+	int king = position->kingSquare[color];
+
+	if (src == king) {
+		Bitboard occupied = position->allPieces ^ squareBit(src);
+		if (attackersTo(position, dest, !color, occupied)) {
+			return 1;
+		}
+		return 0;
+	}
+
+	if ((position->pinned & squareBit(src)) && !(lineSquares[king][src] & squareBit(dest))) {
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: moveIgnoresCheck
+*	Input: Position* position, int src, int dest
+*	Output: int (0 or 1)
+*	Function Operation: this function check if moving the piece on src to dest doesn't prevent the
+*	current check situation of the side to move-> in case of two threatening pieces, only King move
+*	is available (its safety is tested by moveExposesKing()). in case of one threatening piece,
+*	the destination must be the threatening piece or square between it and the King.
+*	If the move doesn't prevent the check - return 1.
+*	If there is no check situation, or the move prevents it - return 0.
+***************************************************************************************************/
+int moveIgnoresCheck(Position* position, int src, int dest) {
+
+	int color = position->mailbox[src] / PIECE_TYPES;
+	int king = position->kingSquare[color];
+	Bitboard checkers = position->checkers;
+
+	if (!checkers || src == king) {
+		return 0;
+	}
+
+	// Two threatening pieces can't be captured or blocked together
+	if (checkers & (checkers - 1)) {
+		return 1;
+	}
+
+	if ((checkers | betweenSquares[king][lowestSquare(checkers)]) & squareBit(dest)) {
+		return 0;
+	}
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: moveCauseToCheckThreat
+*	Input: Position* position, Move* move
+*	Output: int (0 or 1)
+*	Function Operation: this function check if the move cause to check threat to the player side color.
+*	According to chess rules, player can't make move that leads to a capture threat on his king.
+*	The test is done by moveExposesKing() on the source and destination of Move, or by
+*	enPassantExposesKing() in case of en passant capture.
+*	If the move leads to check case on the player which its his trun - return 1
+*	Id the move does not lead to check case - return 0
+***************************************************************************************************/
+int moveCauseToCheckThreat(Position* position, Move* move) {
+	if (move->isEnPassant) {
+		return enPassantExposesKing(position, squareIndex(move->iSrc, move->jSrc), squareIndex(move->iDest, move->jDest));
+	}
+	return moveExposesKing(position, squareIndex(move->iSrc, move->jSrc), squareIndex(move->iDest, move->jDest));
+}
+
+/*************************************************************************************************
+*	Function name: limitedMoveInCheckCase
+*	Input: Position* position, Move* move
+*	Output: int (0 or 1)
+*	Function Operation: this function check at first the current position before perfroming the requested
+*	move-> If there is check situation on the color turn, it means that there are specific moves which
+*	can be made in order to prevent king capture.
+*	- Moving the king.
+*	- Blocking the offensive line of the threatening piece.
+*	- capturing of the threatening piece
+*	Any other move is ilegal. The test is done by moveIgnoresCheck() on the source and destination of Move.
+*	If the move didnt prevent the check threat - return 1.
+*	If there was no check situation on the original position, or the move prevented check
+*	situation - return 0. en passant capture was already tested with the check by
+*	moveCauseToCheckThreat(), so 0 return for it.
+***************************************************************************************************/
+int limitedMoveInCheckCase(Position* position, Move* move) {
+	if (move->isEnPassant) {
+		return 0;
+	}
+	return moveIgnoresCheck(position, squareIndex(move->iSrc, move->jSrc), squareIndex(move->iDest, move->jDest));
+}
+
+
+// make move and perfrom change on board
+
+/*************************************************************************************************
+*	Function name: doMove
+*	Input: Position* position, EncodedMove move, UndoInfo* undo
+*	Output: None
+*	Function Operation: this function performs move in place on the position - the piece on the
+*	source moves to the destination, the captured piece (if exist) is removed and in case of
+*	promotion the piece is replaced by the promotion piece type. in case of castling the Rook
+*	moves too, and the castling rights of the squares of the move are removed. in case of en
+*	passant the captured Pawn is removed from its square, and after Pawn move of two steps the en
+*	passant square is set if the capture is possible. the halfmove clock is reset by Pawn move or
+*	capture and incremented by any other move, and the move number grows after black move. the
+*	turn passes to the other color and its check state is updated. the Zobrist key follows the
+*	pieces which are removed and placed, and the turn key is toggled. all the information which is
+*	needed in order to revert the move is saved in undo.
+***************************************************************************************************/
+void doMove(Position* position, EncodedMove move, UndoInfo* undo) {
+
+	int src = moveSrc(move);
+	int dest = moveDest(move);
+	int promotionType = movePromotionType(move);
+	int pieceCode = position->mailbox[src];
+	int color = pieceCode / PIECE_TYPES;
+	int type = promotionType >= 0 ? promotionType : pieceCode % PIECE_TYPES;
+
+	undo->move = move;
+	undo->movedPiece = pieceCode;
+	undo->capturedPiece = position->mailbox[dest];
+	undo->castlingRights = position->castlingRights;
+	undo->enPassantSquare = position->enPassantSquare;
+	undo->halfmoveClock = position->halfmoveClock;
+	undo->checkers = position->checkers;
+	undo->pinned = position->pinned;
+
+	if ((move >> 12) == MOVE_EN_PASSANT) {
+		int captured = enPassantCapturedSquare(src, dest);
+		undo->capturedPiece = position->mailbox[captured];
+		removePiece(position, captured);
+	}
+
+	// Change the source location to be empty and remove the captured piece (if exist)
+	removePiece(position, src);
+	removePiece(position, dest);
+	placePiece(position, color, type, dest);
+
+	if ((move >> 12) == MOVE_CASTLING) {
+		CastlingMove* castling = &castlingMoves[castlingIndex(move, color)];
+		removePiece(position, castling->rookSrc);
+		placePiece(position, color, ROOK_TYPE, castling->rookDest);
+	}
+	if (position->castlingRights) {
+		setCastlingRights(position, position->castlingRights & castlingMasks[src] & castlingMasks[dest]);
+	}
+	if (position->enPassantSquare >= 0) {
+		setEnPassantSquare(position, -1);
+	}
+
+	if (pieceCode % PIECE_TYPES == PAWN_TYPE || undo->capturedPiece != NO_PIECE) {
+		position->halfmoveClock = 0;
+	}
+	else {
+		position->halfmoveClock++;
+	}
+	if (color == BLACK_COLOR) {
+		position->fullmoveNumber++;
+	}
+
+	position->isWhiteTurn = !position->isWhiteTurn;
+	position->key ^= zobristBlackTurn;
+
+	// The en passant square is tested after the turn passed, against the Pawns of the new side to move
+	if (type == PAWN_TYPE && (dest - src == 2 * SIZE || src - dest == 2 * SIZE)
+		&& isEnPassantPossible(position, (src + dest) / 2)) {
+		setEnPassantSquare(position, (src + dest) / 2);
+	}
+	updateCheckState(position, dest);
+}
+
+/*************************************************************************************************
+*	Function name: undoMove
+*	Input: Position* position, UndoInfo* undo
+*	Output: None
+*	Function Operation: this function reverts move which was performed by doMove(), according to
+*	the information which was saved in undo. the moved piece returns to its source, the captured
+*	piece returns to the destination (or to its square in case of en passant, and the Rook to its
+*	corner in case of castling), and the turn, the castling rights, the en passant square, the
+*	clocks and the check state are restored.
+***************************************************************************************************/
+void undoMove(Position* position, UndoInfo* undo) {
+
+	int src = moveSrc(undo->move);
+	int dest = moveDest(undo->move);
+	int color = undo->movedPiece / PIECE_TYPES;
+
+	// The Rook is returned before the King, because the Rook may arrive to the King source
+	removePiece(position, dest);
+	if ((undo->move >> 12) == MOVE_CASTLING) {
+		CastlingMove* castling = &castlingMoves[castlingIndex(undo->move, color)];
+		removePiece(position, castling->rookDest);
+		placePiece(position, color, ROOK_TYPE, castling->rookSrc);
+	}
+	placePiece(position, color, undo->movedPiece % PIECE_TYPES, src);
+	if (undo->capturedPiece != NO_PIECE) {
+		int captured = (undo->move >> 12) == MOVE_EN_PASSANT ? enPassantCapturedSquare(src, dest) : dest;
+		placePiece(position, undo->capturedPiece / PIECE_TYPES, undo->capturedPiece % PIECE_TYPES, captured);
+	}
+
+	setCastlingRights(position, undo->castlingRights);
+	setEnPassantSquare(position, undo->enPassantSquare);
+	position->halfmoveClock = undo->halfmoveClock;
+	if (color == BLACK_COLOR) {
+		position->fullmoveNumber--;
+	}
+	position->isWhiteTurn = !position->isWhiteTurn;
+	position->key ^= zobristBlackTurn;
+	position->checkers = undo->checkers;
+	position->pinned = undo->pinned;
+}
+
+/*************************************************************************************************
+*	Function name: performMove
+*	Input: Position* position, Move* move
+*	Output: None
+*	Function Operation: this function recieves current position and Move that need to be performed
+*	on the position. the move is performed by doMove(), and it is not needed to revert it.
+***************************************************************************************************/
+void performMove(Position* position, Move* move) {
+
+	UndoInfo undo;
+
+	doMove(position, encodeAnnotatedMove(move), &undo);
+}
+
+/*************************************************************************************************
+*	Function name: makePositionMove
+*	Input: Position* position, const char pgn[], int length
+*	Output: int (MOVE_ILLEGAL, MOVE_LEGAL or MOVE_STALEMATE)
+*	Function Operation: this function recieves bitboard position and PGN of length chars, which
+*	doesn't have to be NUL terminated. the color of turn is defined by the position.
+	(1) At first, there is initialize of Move by using initMove() function which parse the infromation
+		from PGN and look for optional move on position.
+	(2) Then, there is testing of check conidtions on the current position after perfroming the initialized
+		Move which back from initMove() function. the tests are done by testCheckConditions().
+	(3) If the move which back from initMove() and from testCheckConditions() is legal, perform move
+		on the position by using performMove() function and return MOVE_LEGAL, or MOVE_STALEMATE if
+		the opponent has no legal move and is not in check. If the move is ilegal return MOVE_ILLEGAL.
+***************************************************************************************************/
+int makePositionMove(Position* position, const char pgn[], int length) {
+
+	Move move;
+	initMove(position, pgn, length, &move);
+
+	if (move.isLegal) {
+		testCheckConditions(position, &move);
+	}
+
+	if (move.isLegal) {
+		performMove(position, &move);
+		return move.isStalemate ? MOVE_STALEMATE : MOVE_LEGAL;
+	}
+	return MOVE_ILLEGAL;
+}
+
+/*************************************************************************************************
+*	Function name: makeUndoableMove
+*	Input: Position* position, const char pgn[], int length, UndoInfo* undo
+*	Output: int (0 or 1)
+*	Function Operation: this function is the same as makePositionMove(), but the legal move is
+*	performed by doMove() with undo, so the caller can revert it by undoMove(). 1 return if the
+*	move is legal, otherwise 0 and the position and undo are not changed.
+***************************************************************************************************/
+int makeUndoableMove(Position* position, const char pgn[], int length, UndoInfo* undo) {
+
+	Move move;
+	initMove(position, pgn, length, &move);
+
+	if (move.isLegal) {
+		testCheckConditions(position, &move);
+	}
+
+	if (move.isLegal) {
+		doMove(position, encodeAnnotatedMove(&move), undo);
+		return 1;
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: makeMove
+*	Input: char board[][SIZE], char pgn[], int isWhiteTurn
+*	Output: int (0 or 1)
+*	Function Operation: this function recieves board as 2D array, String of PGN and color turn.
+*	the board is loaded to bitboard position, the move is made by makePositionMove() and in case
+*	that the move is legal, the 2D array board is derived back from the position and 1 return.
+*	If the move is ilegal the board is not changed and 0 return.
+***************************************************************************************************/
+int makeMove(char board[][SIZE], char pgn[], int isWhiteTurn) {
+
+	Position position;
+	loadPosition(&position, board, isWhiteTurn);
+
+	if (makePositionMove(&position, pgn, (int)strlen(pgn))) {
+		positionToBoard(&position, board);
+		return 1;
+	}
+	return 0;
+}
+
+
+//moves generation
+
+
+/*************************************************************************************************
+*	Function name: addMove
+*	Input: MoveList* list, int src, int dest, int promotionType
+*	Output: None
+*	Function Operation: the function adds move to the end of the move list. promotionType is -1
+*	for move without promotion.
+***************************************************************************************************/
+void addMove(MoveList* list, int src, int dest, int promotionType) {
+	list->moves[list->count++] = encodeMove(src, dest, promotionType);
+}
+
+/*************************************************************************************************
+*	Function name: addPawnMoves
+*	Input: MoveList* list, int src, Bitboard targets, int lastLine
+*	Output: None
+*	Function Operation: the function adds Pawn move from src to any square in targets. according to
+*	checkPawnMove() rules, Pawn which arrives to the edge line must be promoted, so in this case
+*	there is one move for any promotion piece type: Queen, Rook, Bishop and Knight.
+***************************************************************************************************/
+void addPawnMoves(MoveList* list, int src, Bitboard targets, int lastLine) {
+
+	while (targets) {
+		int dest = popLowestSquare(&targets);
+		if (dest / SIZE == lastLine) {
+			for (int type = QUEEN_TYPE; type >= KNIGHT_TYPE; type--) {
+				addMove(list, src, dest, type);
+			}
+		}
+		else {
+			addMove(list, src, dest, -1);
+		}
+	}
+}
+
+/*************************************************************************************************
+*	Function name: generatePseudoLegalMoves
+*	Input: Position* position, MoveList* list
+*	Output: int (number of moves)
+*	Function Operation: this function fills the move list with all the moves of the side to move
+*	which follow the piece rules of check*Move() functions, without testing the King safety:
+*	- Pawn pushes one step to empty square, or two steps from the second line when both squares
+*	  are empty, and captures diagonally opponent pieces. on the edge line Pawn is promoted.
+*	- Knight and King move to any square in their attack tables.
+*	- Bishop, Rook and Queen move to any square in their sliding attacks until the first piece.
+*	- King castles if isCastlingAvailable() (see addCastlingMoves()).
+*	- Pawn captures en passant if there is en passant square (see addEnPassantMoves()).
+*	Destination with piece in the same color is never added. The list has fixed capacity and
+*	no memory is allocated.
+***************************************************************************************************/
+int generatePseudoLegalMoves(Position* position, MoveList* list) {
+
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	Bitboard* pieces = position->pieces[color];
+	Bitboard targets = ~position->occupancy[color];
+	Bitboard empty = ~position->allPieces;
+	int secondLine = color == WHITE_COLOR ? SIZE - 2 : 1;
+	int lastLine = color == WHITE_COLOR ? 0 : SIZE - 1;
+
+	list->count = 0;
+
+	Bitboard pawns = pieces[PAWN_TYPE];
+	while (pawns) {
+		int src = popLowestSquare(&pawns);
+		Bitboard pushes = pawnPushes(color, src) & empty;
+		if (pushes && src / SIZE == secondLine) {
+			pushes |= pawnPushes(color, lowestSquare(pushes)) & empty;
+		}
+		addPawnMoves(list, src, pushes | (pawnAttacks(color, src) & position->occupancy[!color]), lastLine);
+	}
+
+	for (int type = KNIGHT_TYPE; type <= KING_TYPE; type++) {
+		Bitboard movers = pieces[type];
+		while (movers) {
+			int src = popLowestSquare(&movers);
+			Bitboard attacks;
+			switch (type) {
+			case KNIGHT_TYPE:
+				attacks = knightAttacks(src);
+				break;
+			case BISHOP_TYPE:
+				attacks = bishopAttacks(src, position->allPieces);
+				break;
+			case ROOK_TYPE:
+				attacks = rookAttacks(src, position->allPieces);
+				break;
+			case QUEEN_TYPE:
+				attacks = queenAttacks(src, position->allPieces);
+				break;
+			default:
+				attacks = kingAttacks(src);
+				break;
+			}
+			attacks &= targets;
+			while (attacks) {
+				addMove(list, src, popLowestSquare(&attacks), -1);
+			}
+		}
+	}
+
+	addCastlingMoves(position, list);
+	addEnPassantMoves(position, list);
+	return list->count;
+}
+
+/*************************************************************************************************
+*	Function name: addCastlingMoves
+*	Input: Position* position, MoveList* list
+*	Output: None
+*	Function Operation: the function adds the castling moves of the side to move which are
+*	available by isCastlingAvailable(). castling is added as King move with castling flag. unlike
+*	the other moves, the safety of the King path is already tested here.
+***************************************************************************************************/
+void addCastlingMoves(Position* position, MoveList* list) {
+
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+
+	if (!position->castlingRights) {
+		return;
+	}
+
+	for (int index = color * 2; index < color * 2 + 2; index++) {
+		if (isCastlingAvailable(position, index)) {
+			list->moves[list->count++] = encodeMove(castlingMoves[index].kingSrc, castlingMoves[index].kingDest, -1)
+				| (MOVE_CASTLING << 12);
+		}
+	}
+}
+
+/*************************************************************************************************
+*	Function name: addEnPassantMoves
+*	Input: Position* position, MoveList* list
+*	Output: None
+*	Function Operation: the function adds the en passant captures of the side to move - from any
+*	Pawn which attacks the en passant square. the Pawns are found by the attacks of Pawn in the
+*	opposite color from the en passant square.
+***************************************************************************************************/
+void addEnPassantMoves(Position* position, MoveList* list) {
+
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	int square = position->enPassantSquare;
+
+	if (square < 0) {
+		return;
+	}
+
+	Bitboard pawns = pawnAttacks(!color, square) & position->pieces[color][PAWN_TYPE];
+	while (pawns) {
+		list->moves[list->count++] = encodeMove(popLowestSquare(&pawns), square, -1) | (MOVE_EN_PASSANT << 12);
+	}
+}
+
+/*************************************************************************************************
+*	Function name: generateLegalMoves
+*	Input: Position* position, MoveList* list
+*	Output: int (number of moves)
+*	Function Operation: this function fills the move list with all the legal moves of the side to
+*	move. the pseudo legal moves are generated by generatePseudoLegalMoves(), and any move which
+*	exposes the King or doesn't prevent current check is removed. the tests are the same tests
+*	which are used for PGN move (moveExposesKing() and moveIgnoresCheck(), or enPassantExposesKing()
+*	for en passant capture).
+***************************************************************************************************/
+int generateLegalMoves(Position* position, MoveList* list) {
+
+	int legalCount = 0;
+
+	generatePseudoLegalMoves(position, list);
+
+	for (int z = 0; z < list->count; z++) {
+		EncodedMove move = list->moves[z];
+		int src = moveSrc(move);
+		int dest = moveDest(move);
+		if ((move >> 12) == MOVE_EN_PASSANT) {
+			if (!enPassantExposesKing(position, src, dest)) {
+				list->moves[legalCount++] = move;
+			}
+		}
+		else if (!moveExposesKing(position, src, dest) && !moveIgnoresCheck(position, src, dest)) {
+			list->moves[legalCount++] = move;
+		}
+	}
+
+	list->count = legalCount;
+	return legalCount;
+}
+
+/*************************************************************************************************
+*	Function name: hasLegalReply
+*	Input: Position* position
+*	Output: int (0 or 1)
+*	Function Operation: this function returns 1 if the side to move has any legal move, otherwise
+*	0. unlike generateLegalMoves(), no move list is built and the search stops at the first legal
+*	move, with the same tests by the check state of position:
+*	(1) King steps to square which is not attacked. in case of double check only King can move.
+*	(2) in case of single check, the other pieces must capture the threatening piece or block it,
+*		and pinned piece moves only on the line of its King.
+*	(3) Pawn pushes and captures, and en passant capture by enPassantExposesKing().
+*	castling is not tested, because King which may castle may step to the square next to it.
+***************************************************************************************************/
+int hasLegalReply(Position* position) {
+
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	Bitboard* pieces = position->pieces[color];
+	Bitboard checkers = position->checkers;
+	Bitboard empty = ~position->allPieces;
+	Bitboard targets = ~position->occupancy[color];
+	int king = position->kingSquare[color];
+	int secondLine = color == WHITE_COLOR ? SIZE - 2 : 1;
+
+	if (king >= 0) {
+		Bitboard steps = kingAttacks(king) & targets;
+		Bitboard occupied = position->allPieces ^ squareBit(king);
+		while (steps) {
+			if (!attackersTo(position, popLowestSquare(&steps), !color, occupied)) {
+				return 1;
+			}
+		}
+
+		// Two threatening pieces can't be captured or blocked together
+		if (checkers & (checkers - 1)) {
+			return 0;
+		}
+		if (checkers) {
+			targets &= checkers | betweenSquares[king][lowestSquare(checkers)];
+		}
+	}
+
+	for (int type = KNIGHT_TYPE; type <= QUEEN_TYPE; type++) {
+		Bitboard movers = pieces[type];
+		while (movers) {
+			int src = popLowestSquare(&movers);
+			Bitboard attacks;
+			switch (type) {
+			case KNIGHT_TYPE:
+				attacks = knightAttacks(src);
+				break;
+			case BISHOP_TYPE:
+				attacks = bishopAttacks(src, position->allPieces);
+				break;
+			case ROOK_TYPE:
+				attacks = rookAttacks(src, position->allPieces);
+				break;
+			default:
+				attacks = queenAttacks(src, position->allPieces);
+				break;
+			}
+			attacks &= targets;
+			if (position->pinned & squareBit(src)) {
+				attacks &= lineSquares[king][src];
+			}
+			if (attacks) {
+				return 1;
+			}
+		}
+	}
+
+	Bitboard pawns = pieces[PAWN_TYPE];
+	while (pawns) {
+		int src = popLowestSquare(&pawns);
+		Bitboard pushes = pawnPushes(color, src) & empty;
+		if (pushes && src / SIZE == secondLine) {
+			pushes |= pawnPushes(color, lowestSquare(pushes)) & empty;
+		}
+		Bitboard moves = (pushes | (pawnAttacks(color, src) & position->occupancy[!color])) & targets;
+		if (position->pinned & squareBit(src)) {
+			moves &= lineSquares[king][src];
+		}
+		if (moves) {
+			return 1;
+		}
+	}
+
+	if (position->enPassantSquare >= 0) {
+		Bitboard capturers = pawnAttacks(!color, position->enPassantSquare) & pieces[PAWN_TYPE];
+		while (capturers) {
+			if (!enPassantExposesKing(position, popLowestSquare(&capturers), position->enPassantSquare)) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+
+//perft
+
+
+/*************************************************************************************************
+*	Function name: currentSeconds
+*	Input: None
+*	Output: double (seconds)
+*	Function Operation: the function returns the current wall clock time in seconds. it is used
+*	in order to measure the elapsed time of benchmarks.
+***************************************************************************************************/
+double currentSeconds() {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/*************************************************************************************************
+*	Function name: moveToCoordinates
+*	Input: EncodedMove move, char text[]
+*	Output: None
+*	Function Operation: the function writes the move in coordinates notation to text, for example
+*	"e2e4" or "b7b8q" in case of promotion. text must have place for 6 chars.
+***************************************************************************************************/
+void moveToCoordinates(EncodedMove move, char text[]) {
+
+	int src = moveSrc(move);
+	int dest = moveDest(move);
+	int promotionType = movePromotionType(move);
+
+	text[0] = FIRST_COL + src % SIZE;
+	text[1] = '0' + SIZE - src / SIZE;
+	text[2] = FIRST_COL + dest % SIZE;
+	text[3] = '0' + SIZE - dest / SIZE;
+	text[4] = promotionType >= 0 ? tolower(PIECE_CHARS[promotionType]) : '\0';
+	text[5] = '\0';
+}
+
+/*************************************************************************************************
+*	Function name: perft
+*	Input: Position* position, int depth
+*	Output: unsigned long long (number of nodes)
+*	Function Operation: this function counts the leaf nodes of the legal moves tree of position
+*	in the given depth. any move is performed by doMove() and reverted by undoMove(), and in the
+*	last level the moves are only counted.
+***************************************************************************************************/
+unsigned long long perft(Position* position, int depth) {
+
+	MoveList list;
+	UndoInfo undo;
+	unsigned long long nodes = 0;
+
+	if (depth <= 0) {
+		return 1;
+	}
+
+	generateLegalMoves(position, &list);
+	if (depth == 1) {
+		return list.count;
+	}
+
+	for (int z = 0; z < list.count; z++) {
+		doMove(position, list.moves[z], &undo);
+		nodes += perft(position, depth - 1);
+		undoMove(position, &undo);
+	}
+	return nodes;
+}
+
+/*************************************************************************************************
+*	Function name: perftDivide
+*	Input: Position* position, int depth
+*	Output: unsigned long long (number of nodes)
+*	Function Operation: this function counts the nodes like perft(), and prints the number of nodes
+*	under any legal move of position, the total number of nodes and the nodes per second.
+***************************************************************************************************/
+unsigned long long perftDivide(Position* position, int depth) {
+
+	MoveList list;
+	UndoInfo undo;
+	char text[6];
+	unsigned long long nodes = 0;
+	double startTime = currentSeconds();
+
+	generateLegalMoves(position, &list);
+
+	for (int z = 0; z < list.count; z++) {
+		doMove(position, list.moves[z], &undo);
+		unsigned long long moveNodes = perft(position, depth - 1);
+		undoMove(position, &undo);
+
+		moveToCoordinates(list.moves[z], text);
+		printf("%s: %llu\n", text, moveNodes);
+		nodes += moveNodes;
+	}
+
+	double elapsed = currentSeconds() - startTime;
+	printf("\nNodes: %llu\n", nodes);
+	printf("Time: %.3f s\n", elapsed);
+	printf("Nodes/second: %.0f\n", elapsed > 0 ? nodes / elapsed : 0.0);
+	return nodes;
+}
+
+/*************************************************************************************************
+*	Function name: runPerft
+*	Input: const char fen[], int depth, int isDivide
+*	Output: int (FEN_OK or FEN error)
+*	Function Operation: this function runs perft on the position of fen. if isDivide is set, the
+*	nodes of depth are divided by the legal moves of position by perftDivide(). otherwise the
+*	nodes of any depth from 1 to depth are printed with the time and the nodes per second. the
+*	error of fen is returned if the position can't be created.
+***************************************************************************************************/
+int runPerft(const char fen[], int depth, int isDivide) {
+
+	Position position;
+	int error = createPosition(&position, fen);
+
+	if (error != FEN_OK) {
+		return error;
+	}
+	if (isDivide) {
+		perftDivide(&position, depth);
+		return FEN_OK;
+	}
+
+	for (int level = 1; level <= depth; level++) {
+		double startTime = currentSeconds();
+		unsigned long long nodes = perft(&position, level);
+		double elapsed = currentSeconds() - startTime;
+		printf("depth %d: %llu nodes, %.3f s, %.0f nodes/second\n", level, nodes, elapsed,
+			elapsed > 0 ? nodes / elapsed : 0.0);
+	}
+	return FEN_OK;
+}
+
+/*************************************************************************************************
+*	Function name: runPerftSuite
+*	Input: int maxDepth
+*	Output: int (number of failures)
+*	Function Operation: this function runs perft() on any reference position in PERFT_REFERENCES
+*	which its depth is not more than maxDepth, and compares the result to the expected number
+*	of nodes. any reference is printed with its result and the nodes per second, and at the end
+*	the total throughput is printed. the number of references which failed is returned.
+***************************************************************************************************/
+int runPerftSuite(int maxDepth) {
+
+	int failures = 0;
+	unsigned long long totalNodes = 0;
+	double totalTime = 0;
+
+	for (int z = 0; z < PERFT_REFERENCES_COUNT; z++) {
+
+		const PerftReference* reference = &PERFT_REFERENCES[z];
+		Position position;
+
+		if (reference->depth > maxDepth) {
+			continue;
+		}
+
+		createPosition(&position, reference->fen);
+		double startTime = currentSeconds();
+		unsigned long long nodes = perft(&position, reference->depth);
+		double elapsed = currentSeconds() - startTime;
+
+		totalNodes += nodes;
+		totalTime += elapsed;
+		if (nodes != reference->nodes) {
+			failures++;
+		}
+
+		printf("%s %s depth %d: %llu (expected %llu) %.0f nodes/second\n", nodes == reference->nodes ? "ok" : "FAILED",
+			reference->fen, reference->depth, nodes, reference->nodes, elapsed > 0 ? nodes / elapsed : 0.0);
+	}
+
+	printf("Total: %llu nodes, %.3f s, %.0f nodes/second, %d failed\n", totalNodes, totalTime,
+		totalTime > 0 ? totalNodes / totalTime : 0.0, failures);
+	return failures;
+}
+
+
+//PGN games reader
+
+
+/*************************************************************************************************
+*	Function name: initPgnReader
+*	Input: PgnReader* reader, FILE* file
+*	Output: None
+*	Function Operation: the function initializes PGN reader on open file. the file is read later
+*	in chunks into the fixed buffer of reader, so the memory doesn't depend on the file size.
+***************************************************************************************************/
+void initPgnReader(PgnReader* reader, FILE* file) {
+	reader->file = file;
+	reader->data = reader->buffer;
+	reader->length = 0;
+	reader->index = 0;
+	reader->tokenStart = 0;
+	reader->isInToken = 0;
+	reader->isMapped = 0;
+	reader->line = 1;
+	reader->games = 0;
+	reader->table = NULL;
+}
+
+/*************************************************************************************************
+*	Function name: initPgnMemoryReader
+*	Input: PgnReader* reader, const char data[], size_t length
+*	Output: None
+*	Function Operation: the function initializes PGN reader on PGN text which is already in memory.
+*	the tokens are views to data itself, so nothing is copied and data is not changed.
+***************************************************************************************************/
+void initPgnMemoryReader(PgnReader* reader, const char data[], size_t length) {
+	initPgnReader(reader, NULL);
+	reader->data = data;
+	reader->length = length;
+}
+
+/*************************************************************************************************
+*	Function name: openPgnFile
+*	Input: PgnReader* reader, const char path[]
+*	Output: int (0 or 1)
+*	Function Operation: the function opens PGN file for reading. where mmap() is available, the
+*	whole file is mapped to memory and parsed in place by memory reader. otherwise (or if the
+*	mapping fails) the file is read in chunks. 1 return if the file was opened, otherwise 0.
+***************************************************************************************************/
+int openPgnFile(PgnReader* reader, const char path[]) {
+
+#if MMAP_SUPPORT
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+
+	if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+		void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			close(fd);
+			posix_madvise(mapping, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+			initPgnMemoryReader(reader, (const char*)mapping, (size_t)info.st_size);
+			reader->isMapped = 1;
+			return 1;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+#endif
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return 0;
+	}
+	initPgnReader(reader, file);
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: closePgnFile
+*	Input: PgnReader* reader
+*	Output: None
+*	Function Operation: the function releases PGN file which was opened by openPgnFile(): the
+*	mapping is removed, or the file is closed.
+***************************************************************************************************/
+void closePgnFile(PgnReader* reader) {
+#if MMAP_SUPPORT
+	if (reader->isMapped) {
+		munmap((void*)reader->data, reader->length);
+		reader->isMapped = 0;
+		return;
+	}
+#endif
+	if (reader->file != NULL) {
+		fclose(reader->file);
+		reader->file = NULL;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: pgnPeekChar
+*	Input: PgnReader* reader
+*	Output: int (next char or EOF)
+*	Function Operation: the function returns the next char of PGN without consuming it.
+*	in case of file reader which consumed its buffer, the next chunk of the file is read. the
+*	token which is read at the moment is moved to the start of buffer before, so any token is
+*	contiguous view to the buffer (token longer than the buffer loses its beginning).
+***************************************************************************************************/
+int pgnPeekChar(PgnReader* reader) {
+
+	if (reader->index == reader->length) {
+
+		size_t kept = 0;
+
+		if (reader->file == NULL) {
+			return EOF;
+		}
+		if (reader->isInToken && reader->length - reader->tokenStart < PGN_BUFFER_SIZE) {
+			kept = reader->length - reader->tokenStart;
+			memmove(reader->buffer, reader->buffer + reader->tokenStart, kept);
+		}
+		reader->tokenStart = 0;
+		reader->length = kept + fread(reader->buffer + kept, 1, PGN_BUFFER_SIZE - kept, reader->file);
+		reader->index = kept;
+
+		if (reader->index == reader->length) {
+			return EOF;
+		}
+	}
+	return (unsigned char)reader->data[reader->index];
+}
+
+/*************************************************************************************************
+*	Function name: pgnNextChar
+*	Input: PgnReader* reader
+*	Output: int (next char or EOF)
+*	Function Operation: the function consumes and returns the next char of PGN, and counts
+*	the lines which were read.
+***************************************************************************************************/
+int pgnNextChar(PgnReader* reader) {
+	int c = pgnPeekChar(reader);
+	if (c != EOF) {
+		reader->index++;
+		if (c == '\n') {
+			reader->line++;
+		}
+	}
+	return c;
+}
+
+/*************************************************************************************************
+*	Function name: skipPgnSeparators
+*	Input: PgnReader* reader
+*	Output: int (next char or EOF)
+*	Function Operation: the function skips everything in PGN which is not tag, move or result:
+*	white spaces, comments in braces, comments from ';' or '%' until the end of line, numeric
+*	annotation glyphs ($n) and variations in parentheses (which may be nested and include
+*	comments). the next char after them is returned without consuming it.
+***************************************************************************************************/
+int skipPgnSeparators(PgnReader* reader) {
+
+	int depth = 0;
+
+	while (1) {
+		int c = pgnPeekChar(reader);
+
+		if (c == EOF) {
+			return EOF;
+		}
+		if (c == '{') {
+			while (c != EOF && c != '}') {
+				c = pgnNextChar(reader);
+			}
+		}
+		else if (c == ';' || c == '%') {
+			while (c != EOF && c != '\n') {
+				c = pgnNextChar(reader);
+			}
+		}
+		else if (c == '$') {
+			pgnNextChar(reader);
+			while (isdigit(pgnPeekChar(reader))) {
+				pgnNextChar(reader);
+			}
+		}
+		else if (c == '(') {
+			depth++;
+			pgnNextChar(reader);
+		}
+		else if (c == ')') {
+			if (depth > 0) {
+				depth--;
+			}
+			pgnNextChar(reader);
+		}
+		else if (isspace(c) || depth > 0) {
+			pgnNextChar(reader);
+		}
+		else {
+			return c;
+		}
+	}
+}
+
+/*************************************************************************************************
+*	Function name: pgnTokenIs
+*	Input: PgnToken token, const char text[]
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if the token is exactly the given text, otherwise 0.
+***************************************************************************************************/
+int pgnTokenIs(PgnToken token, const char text[]) {
+	return token.length == (int)strlen(text) && !memcmp(token.text, text, token.length);
+}
+
+/*************************************************************************************************
+*	Function name: readPgnToken
+*	Input: PgnReader* reader, PgnToken* token
+*	Output: int (token type)
+*	Function Operation: the function reads the next token of PGN, and returns its type:
+*	- PGN_TAG for tag pair, token is the text between the brackets.
+*	- PGN_RESULT for game termination marker: 1-0, 0-1, 1/2-1/2 or *.
+*	- PGN_MOVE for SAN move. move numbers ("12." or "12...") before the move and annotation
+*	  suffixes ('!' and '?') after it are not part of the token.
+*	- PGN_END in the end of PGN.
+*	the token is a view to the reader data, which is valid until the next read.
+***************************************************************************************************/
+int readPgnToken(PgnReader* reader, PgnToken* token) {
+
+	while (1) {
+
+		int c = skipPgnSeparators(reader);
+
+		if (c == EOF) {
+			token->text = NULL;
+			token->length = 0;
+			return PGN_END;
+		}
+
+		// Tag pair, the brackets inside the quoted value don't close the tag
+		if (c == '[') {
+			int isQuoted = 0;
+			pgnNextChar(reader);
+			reader->tokenStart = reader->index;
+			reader->isInToken = 1;
+			while ((c = pgnPeekChar(reader)) != EOF && (c != ']' || isQuoted)) {
+				if (c == '\\' && isQuoted) {
+					pgnNextChar(reader);
+				}
+				else if (c == '"') {
+					isQuoted = !isQuoted;
+				}
+				pgnNextChar(reader);
+			}
+			token->text = reader->data + reader->tokenStart;
+			token->length = (int)(reader->index - reader->tokenStart);
+			reader->isInToken = 0;
+			pgnNextChar(reader);
+			return PGN_TAG;
+		}
+
+		// Symbol token, until white space or the next separator
+		reader->tokenStart = reader->index;
+		reader->isInToken = 1;
+		while ((c = pgnPeekChar(reader)) != EOF && !isspace(c) && !strchr("{}();[]$%", c)) {
+			pgnNextChar(reader);
+		}
+		token->text = reader->data + reader->tokenStart;
+		token->length = (int)(reader->index - reader->tokenStart);
+		reader->isInToken = 0;
+
+		if (pgnTokenIs(*token, "1-0") || pgnTokenIs(*token, "0-1") || pgnTokenIs(*token, "1/2-1/2")
+			|| pgnTokenIs(*token, "*")) {
+			return PGN_RESULT;
+		}
+
+		// Move number may be attached to the move, such as "12.e4"
+		int start = 0;
+		while (start < token->length && isdigit((unsigned char)token->text[start])) {
+			start++;
+		}
+		if (start < token->length && token->text[start] == '.') {
+			while (start < token->length && token->text[start] == '.') {
+				start++;
+			}
+			token->text += start;
+			token->length -= start;
+		}
+
+		// Annotation suffixes of the move
+		while (token->length > 0 && (token->text[token->length - 1] == '!' || token->text[token->length - 1] == '?')) {
+			token->length--;
+		}
+
+		// Standalone move number or en passant mark is not a move
+		if (token->length == 0 || pgnTokenIs(*token, "e.p.")) {
+			continue;
+		}
+		return PGN_MOVE;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: pgnTagValue
+*	Input: PgnToken tag, const char name[], char value[], int size
+*	Output: int (0 or 1)
+*	Function Operation: the function checks if tag (the text between the brackets) is the tag pair
+*	with the given name. if it is, the unescaped value between the quotes is copied to value (up to
+*	size - 1 chars) and 1 return, otherwise 0 return.
+***************************************************************************************************/
+int pgnTagValue(PgnToken tag, const char name[], char value[], int size) {
+
+	int length = (int)strlen(name);
+	int c = 0;
+	int v = 0;
+
+	while (c < tag.length && isspace((unsigned char)tag.text[c])) {
+		c++;
+	}
+	if (c + length >= tag.length || memcmp(tag.text + c, name, length) || !isspace((unsigned char)tag.text[c + length])) {
+		return 0;
+	}
+
+	// The value is between the quotes, backslash escapes quote and backslash
+	for (c += length; c < tag.length && tag.text[c] != '"'; c++);
+	if (c == tag.length) {
+		return 0;
+	}
+	for (c++; c < tag.length && tag.text[c] != '"'; c++) {
+		if (tag.text[c] == '\\' && c + 1 < tag.length) {
+			c++;
+		}
+		if (v < size - 1) {
+			value[v++] = tag.text[c];
+		}
+	}
+	value[v] = '\0';
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: readPgnGame
+*	Input: PgnReader* reader, PgnGameVerdict* verdict
+*	Output: int (0 or 1)
+*	Function Operation: the function reads the next game of PGN and validates its moves. the game
+*	starts from the FEN tag if exist, otherwise from the initial position, and any move is made in
+*	place in the reader data by makeCachedMove(), with the transposition table of reader. after the
+*	first illegal move the rest of the moves are only read. the moves are played on game state by
+*	playGameMove(), so the first ply which allows draw claim (by canClaimDraw()) is recorded, and
+*	stalemate after the last legal move too. the game ends with result token, or with tag of the next game which comes after
+*	the moves. the verdict of the game is filled and 1 return. in the end of PGN 0 return.
+***************************************************************************************************/
+int readPgnGame(PgnReader* reader, PgnGameVerdict* verdict) {
+
+	PgnToken token;
+	char fen[PGN_FEN_SIZE];
+	GameState game;
+	int isStarted = 0;
+	int hasMoves = 0;
+	int isValidFen = 1;
+
+	strcpy(fen, START_FEN);
+	verdict->plies = 0;
+	verdict->isStalemate = 0;
+	verdict->drawPly = 0;
+	verdict->illegalPly = 0;
+	verdict->illegalLine = 0;
+	verdict->illegalMove[0] = '\0';
+	verdict->result[0] = '\0';
+
+	while (!(hasMoves && skipPgnSeparators(reader) == '[')) {
+
+		int type = readPgnToken(reader, &token);
+
+		if (type == PGN_END) {
+			break;
+		}
+		isStarted = 1;
+
+		if (type == PGN_TAG) {
+			pgnTagValue(token, "FEN", fen, PGN_FEN_SIZE);
+		}
+		else if (type == PGN_RESULT) {
+			memcpy(verdict->result, token.text, token.length);
+			verdict->result[token.length] = '\0';
+			break;
+		}
+		else {
+			// Game from invalid FEN tag can't make even its first move
+			if (!hasMoves) {
+				isValidFen = createGameState(&game, fen) == FEN_OK;
+				hasMoves = 1;
+			}
+			if (verdict->illegalPly) {
+				continue;
+			}
+			int result = isValidFen ? playGameMove(&game, reader->table, token.text, token.length) : MOVE_ILLEGAL;
+			if (result != MOVE_ILLEGAL) {
+				verdict->plies++;
+				verdict->isStalemate = result == MOVE_STALEMATE;
+				if (!verdict->drawPly && canClaimDraw(&game)) {
+					verdict->drawPly = verdict->plies;
+				}
+			}
+			else {
+				int length = token.length < PGN_MOVE_SIZE - 1 ? token.length : PGN_MOVE_SIZE - 1;
+				verdict->illegalPly = verdict->plies + 1;
+				verdict->illegalLine = reader->line;
+				memcpy(verdict->illegalMove, token.text, length);
+				verdict->illegalMove[length] = '\0';
+			}
+		}
+	}
+
+	if (!isStarted) {
+		return 0;
+	}
+	verdict->gameNumber = ++reader->games;
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: validatePgnGames
+*	Input: PgnReader* reader, FILE* report
+*	Output: long (number of games with illegal move)
+*	Function Operation: the function validates all the games of PGN reader in single pass, and
+*	writes to report the first illegal move of any game which has one, and a summary line.
+***************************************************************************************************/
+long validatePgnGames(PgnReader* reader, FILE* report) {
+
+	PgnGameVerdict verdict;
+	long illegalGames = 0;
+
+	while (readPgnGame(reader, &verdict)) {
+		if (verdict.illegalPly) {
+			illegalGames++;
+			fprintf(report, "Game %ld: illegal move %s at ply %d (line %ld)\n", verdict.gameNumber,
+				verdict.illegalMove, verdict.illegalPly, verdict.illegalLine);
+		}
+	}
+
+	fprintf(report, "Games: %ld, illegal: %ld\n", reader->games, illegalGames);
+	return illegalGames;
+}
+
+/*************************************************************************************************
+*	Function name: validatePgnFile
+*	Input: const char path[], FILE* report
+*	Output: long (number of games with illegal move, -1 if the file can't be opened)
+*	Function Operation: the function opens PGN file by openPgnFile() (memory mapped where it is
+*	possible) and validates all its games by validatePgnGames().
+***************************************************************************************************/
+long validatePgnFile(const char path[], FILE* report) {
+
+	PgnReader* reader = malloc(sizeof(PgnReader));
+	long illegalGames = -1;
+
+	if (reader == NULL) {
+		return -1;
+	}
+
+	if (openPgnFile(reader, path)) {
+		illegalGames = validatePgnGames(reader, report);
+		closePgnFile(reader);
+	}
+
+	free(reader);
+	return illegalGames;
+}
+
+
+//batch validation
+
+
+/*************************************************************************************************
+*	Function name: processorsCount
+*	Input: None
+*	Output: int (number of processors)
+*	Function Operation: the function returns the number of online processors where it is known,
+*	otherwise 1.
+***************************************************************************************************/
+int processorsCount() {
+#if defined(_SC_NPROCESSORS_ONLN)
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#else
+	return 1;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: validatePgnGame
+*	Input: PgnReader* reader, const PgnGameInput* game, PgnGameVerdict* verdict
+*	Output: None
+*	Function Operation: the function validates single game of batch in place by memory reader, and
+*	fills its verdict. the transposition table of reader is kept for the game. game without any
+*	token gets empty verdict.
+***************************************************************************************************/
+void validatePgnGame(PgnReader* reader, const PgnGameInput* game, PgnGameVerdict* verdict) {
+
+	TranspositionTable* table = reader->table;
+
+	initPgnMemoryReader(reader, game->text, game->length);
+	reader->table = table;
+
+	if (!readPgnGame(reader, verdict)) {
+		verdict->plies = 0;
+		verdict->illegalPly = 0;
+		verdict->illegalLine = 0;
+		verdict->illegalMove[0] = '\0';
+		verdict->result[0] = '\0';
+	}
+}
+
+#if THREADS_SUPPORT
+
+/*************************************************************************************************
+*	Function name: popBatchGame
+*	Input: BatchDeque* deque
+*	Output: int (game index or -1)
+*	Function Operation: the function takes the game from the tail of worker deque, and returns its
+*	index. if the deque is empty -1 return.
+***************************************************************************************************/
+int popBatchGame(BatchDeque* deque) {
+
+	int index = -1;
+
+	mtx_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		index = --deque->tail;
+	}
+	mtx_unlock(&deque->lock);
+	return index;
+}
+
+/*************************************************************************************************
+*	Function name: stealBatchGames
+*	Input: BatchDeque* victim, BatchDeque* thief
+*	Output: int (number of stolen games)
+*	Function Operation: the function moves half of the games (rounded up) from the head of victim
+*	deque to the empty deque of thief. the games which are left to the victim are the games near
+*	its tail, which it takes next, so the workers don't compete on the same games.
+***************************************************************************************************/
+int stealBatchGames(BatchDeque* victim, BatchDeque* thief) {
+
+	mtx_lock(&victim->lock);
+	int start = victim->head;
+	int stolen = (victim->tail - victim->head + 1) / 2;
+	victim->head += stolen;
+	mtx_unlock(&victim->lock);
+
+	if (stolen > 0) {
+		mtx_lock(&thief->lock);
+		thief->head = start;
+		thief->tail = start + stolen;
+		mtx_unlock(&thief->lock);
+	}
+	return stolen;
+}
+
+/*************************************************************************************************
+*	Function name: runBatchWorker
+*	Input: void* argument (BatchWorker*)
+*	Output: int (0)
+*	Function Operation: the function is the loop of batch validation worker. the worker validates
+*	the games of its own deque, and when it is empty, steals games from the other workers, in
+*	order from the next worker. games are never added, so when no game can be stolen, all the
+*	games were taken and the worker stops. any verdict is written to the index of its game, so
+*	the verdicts are in input order.
+***************************************************************************************************/
+int runBatchWorker(void* argument) {
+
+	BatchWorker* worker = (BatchWorker*)argument;
+	BatchPool* pool = worker->pool;
+	BatchDeque* own = &pool->deques[worker->id];
+	PgnReader reader;
+
+	reader.table = pool->table;
+
+	while (1) {
+
+		int index = popBatchGame(own);
+
+		if (index < 0) {
+			int k;
+			for (k = 1; k < pool->workers; k++) {
+				if (stealBatchGames(&pool->deques[(worker->id + k) % pool->workers], own)) {
+					break;
+				}
+			}
+			if (k == pool->workers) {
 				return 0;
 			}
+			continue;
+		}
+
+		validatePgnGame(&reader, &pool->games[index], &pool->verdicts[index]);
+		pool->verdicts[index].gameNumber = index + 1;
+	}
+}
+
+#endif
+
+/*************************************************************************************************
+*	Function name: validatePgnBatch
+*	Input: const PgnGameInput games[], int count, PgnGameVerdict verdicts[], int threads,
+*		TranspositionTable* table
+*	Output: long (number of games with illegal move, -1 if memory can't be allocated)
+*	Function Operation: the function validates count games and fills verdicts[i] for games[i].
+*	the games are divided to threads workers (the number of processors if threads is not positive)
+*	in equal contiguous parts, and idle worker steals games from the others, so long games don't
+*	leave the other processors idle. the calling thread is worker 0. without threads support, or
+*	with single worker, the games are validated in the calling thread. all the workers share the
+*	transposition table (if it isn't NULL), so position which was validated by one worker is
+*	cached for all of them.
+***************************************************************************************************/
+long validatePgnBatch(const PgnGameInput games[], int count, PgnGameVerdict verdicts[], int threads,
+	TranspositionTable* table) {
+
+	long illegalGames = 0;
+
+	if (threads <= 0) {
+		threads = processorsCount();
+	}
+	if (threads > count) {
+		threads = count;
+	}
+
+#if THREADS_SUPPORT
+	if (threads > 1) {
+
+		BatchPool pool;
+		BatchWorker* workers = malloc(sizeof(BatchWorker) * threads);
+		thrd_t* handles = malloc(sizeof(thrd_t) * threads);
+		int* isStarted = calloc(threads, sizeof(int));
+
+		pool.deques = malloc(sizeof(BatchDeque) * threads);
+		if (workers == NULL || handles == NULL || isStarted == NULL || pool.deques == NULL) {
+			free(workers);
+			free(handles);
+			free(isStarted);
+			free(pool.deques);
+			return -1;
+		}
+
+		pool.games = games;
+		pool.verdicts = verdicts;
+		pool.table = table;
+		pool.workers = threads;
+		for (int w = 0; w < threads; w++) {
+			mtx_init(&pool.deques[w].lock, mtx_plain);
+			pool.deques[w].head = (int)((long long)count * w / threads);
+			pool.deques[w].tail = (int)((long long)count * (w + 1) / threads);
+			workers[w].pool = &pool;
+			workers[w].id = w;
+		}
+
+		// Worker which can't be started leaves its games to be stolen by the others
+		for (int w = 1; w < threads; w++) {
+			isStarted[w] = thrd_create(&handles[w], runBatchWorker, &workers[w]) == thrd_success;
+		}
+		runBatchWorker(&workers[0]);
+
+		for (int w = 1; w < threads; w++) {
+			if (isStarted[w]) {
+				thrd_join(handles[w], NULL);
+			}
+		}
+		for (int w = 0; w < threads; w++) {
+			mtx_destroy(&pool.deques[w].lock);
+		}
+		free(workers);
+		free(handles);
+		free(isStarted);
+		free(pool.deques);
+	}
+	else
+#endif
+	{
+		PgnReader* reader = malloc(sizeof(PgnReader));
+		if (reader == NULL) {
+			return -1;
+		}
+		reader->table = table;
+		for (int z = 0; z < count; z++) {
+			validatePgnGame(reader, &games[z], &verdicts[z]);
+			verdicts[z].gameNumber = z + 1;
+		}
+		free(reader);
+	}
+
+	for (int z = 0; z < count; z++) {
+		if (verdicts[z].illegalPly) {
+			illegalGames++;
+		}
+	}
+	return illegalGames;
+}
+
+
+//FEN conversion
+
+
+#if SIMD_SUPPORT
+/*************************************************************************************************
+*	Function name: emptySquaresMaskAvx2
+*	Input: const char squares[]
+*	Output: Bitboard
+*	Function Operation: the function compares the squares chars of board to EMPTY 32 chars at a
+*	time by AVX2, and returns bitboard of the empty squares. the squares which are left after the
+*	last full vector are compared one by one. it is called only after the CPU support is checked.
+***************************************************************************************************/
+__attribute__((target("avx2"))) Bitboard emptySquaresMaskAvx2(const char squares[]) {
+
+	__m256i empty = _mm256_set1_epi8(EMPTY);
+	Bitboard mask = 0;
+	int square = 0;
+
+	for (; square + 32 <= SQUARES; square += 32) {
+		__m256i chars = _mm256_loadu_si256((const __m256i*)(squares + square));
+		mask |= (Bitboard)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, empty)) << square;
+	}
+	for (; square < SQUARES; square++) {
+		if (squares[square] == EMPTY) {
+			mask |= squareBit(square);
+		}
+	}
+	return mask;
+}
+
+/*************************************************************************************************
+*	Function name: emptySquaresMaskSse2
+*	Input: const char squares[]
+*	Output: Bitboard
+*	Function Operation: the function is the same as emptySquaresMaskAvx2(), by SSE2 instructions
+*	which compare 16 chars at a time (SSE2 is part of any x86-64 CPU).
+***************************************************************************************************/
+Bitboard emptySquaresMaskSse2(const char squares[]) {
+
+	__m128i empty = _mm_set1_epi8(EMPTY);
+	Bitboard mask = 0;
+	int square = 0;
+
+	for (; square + 16 <= SQUARES; square += 16) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)(squares + square));
+		mask |= (Bitboard)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, empty)) << square;
+	}
+	for (; square < SQUARES; square++) {
+		if (squares[square] == EMPTY) {
+			mask |= squareBit(square);
+		}
+	}
+	return mask;
+}
+
+/*************************************************************************************************
+*	Function name: fillEmptySquaresAvx2
+*	Input: char squares[]
+*	Output: None
+*	Function Operation: the function writes EMPTY to all the squares of board, 32 chars in any
+*	store by AVX2. it is called only after the CPU support is checked.
+***************************************************************************************************/
+__attribute__((target("avx2"))) void fillEmptySquaresAvx2(char squares[]) {
+
+	__m256i empty = _mm256_set1_epi8(EMPTY);
+	int square = 0;
+
+	for (; square + 32 <= SQUARES; square += 32) {
+		_mm256_storeu_si256((__m256i*)(squares + square), empty);
+	}
+	for (; square < SQUARES; square++) {
+		squares[square] = EMPTY;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: fillEmptySquaresSse2
+*	Input: char squares[]
+*	Output: None
+*	Function Operation: the function is the same as fillEmptySquaresAvx2(), by SSE2 stores of 16
+*	chars.
+***************************************************************************************************/
+void fillEmptySquaresSse2(char squares[]) {
+
+	__m128i empty = _mm_set1_epi8(EMPTY);
+	int square = 0;
+
+	for (; square + 16 <= SQUARES; square += 16) {
+		_mm_storeu_si128((__m128i*)(squares + square), empty);
+	}
+	for (; square < SQUARES; square++) {
+		squares[square] = EMPTY;
+	}
+}
+#endif
+
+/*************************************************************************************************
+*	Function name: emptySquaresMask
+*	Input: const char squares[]
+*	Output: Bitboard
+*	Function Operation: the function returns bitboard of the squares of 2D array board (SQUARES
+*	chars in rows order) which are EMPTY. the comparison is done by AVX2 or SSE2 where they are
+*	available, otherwise square by square.
+***************************************************************************************************/
+Bitboard emptySquaresMask(const char squares[]) {
+
+#if SIMD_SUPPORT
+	if (__builtin_cpu_supports("avx2")) {
+		return emptySquaresMaskAvx2(squares);
+	}
+	return emptySquaresMaskSse2(squares);
+#else
+	Bitboard mask = 0;
+	for (int square = 0; square < SQUARES; square++) {
+		if (squares[square] == EMPTY) {
+			mask |= squareBit(square);
+		}
+	}
+	return mask;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: fillEmptySquares
+*	Input: char squares[]
+*	Output: None
+*	Function Operation: the function writes EMPTY to all the squares of 2D array board, by AVX2 or
+*	SSE2 stores where they are available, otherwise by memset().
+***************************************************************************************************/
+void fillEmptySquares(char squares[]) {
+
+#if SIMD_SUPPORT
+	if (__builtin_cpu_supports("avx2")) {
+		fillEmptySquaresAvx2(squares);
+		return;
+	}
+	fillEmptySquaresSse2(squares);
+#else
+	memset(squares, EMPTY, SQUARES);
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: writeFenPlacement
+*	Input: const char squares[], Bitboard empty, char fen[]
+*	Output: int (number of chars which were written)
+*	Function Operation: the function writes the pieces placement part of FEN, according to the
+*	pieces chars of squares and the bitboard of empty squares. any run of empty squares is found
+*	at once by counting the trailing bits of the row mask, and any run of pieces is copied at once,
+*	so there is no loop on the single squares. fen is not NUL terminated.
+***************************************************************************************************/
+int writeFenPlacement(const char squares[], Bitboard empty, char fen[]) {
+
+	int length = 0;
+	Bitboard rowMask = SIZE == 8 ? 0xFFULL : (1ULL << SIZE) - 1;
+
+	for (int i = 0; i < SIZE; i++) {
+
+		Bitboard rowEmpty = (empty >> (i * SIZE)) & rowMask;
+		int j = 0;
+
+		if (i) {
+			fen[length++] = SEP[0];
+		}
+
+		while (j < SIZE) {
+			Bitboard rest = rowEmpty >> j;
+
+			// Run of empty squares is the trailing ones, the bits beyond the row are zeros
+			if (rest & 1) {
+				int run = lowestSquare(~rest);
+				fen[length++] = (char)('0' + run);
+				j += run;
+			}
+			else {
+				int run = rest ? lowestSquare(rest) : SIZE - j;
+				memcpy(fen + length, squares + i * SIZE + j, run);
+				length += run;
+				j += run;
+			}
+		}
+	}
+	return length;
+}
+
+/*************************************************************************************************
+*	Function name: boardToFen
+*	Input: char board[][SIZE], char fen[]
+*	Output: int (length of FEN)
+*	Function Operation: the function writes the pieces placement FEN of 2D array board to fen, and
+*	NUL terminates it. the empty squares are found together by emptySquaresMask(). fen must have
+*	place for SQUARES + SIZE chars.
+***************************************************************************************************/
+int boardToFen(char board[][SIZE], char fen[]) {
+
+	const char* squares = &board[0][0];
+	int length = writeFenPlacement(squares, emptySquaresMask(squares), fen);
+
+	fen[length] = '\0';
+	return length;
+}
+
+/*************************************************************************************************
+*	Function name: positionToFen
+*	Input: Position* position, char fen[]
+*	Output: int (length of FEN)
+*	Function Operation: the function writes the FEN of position with all its six fields to fen,
+*	and NUL terminates it. the empty squares are the complement of the occupied squares bitboard.
+*	fen must have place for FEN_MAX_LENGTH chars.
+***************************************************************************************************/
+int positionToFen(Position* position, char fen[]) {
+
+	char squares[SQUARES];
+	Bitboard occupied = position->allPieces;
+
+	while (occupied) {
+		int square = popLowestSquare(&occupied);
+		squares[square] = pieceCharFromCode(position->mailbox[square]);
+	}
+
+	int length = writeFenPlacement(squares, ~position->allPieces, fen);
+	fen[length++] = ' ';
+	fen[length++] = position->isWhiteTurn ? 'w' : 'b';
+	fen[length++] = ' ';
+	if (!position->castlingRights) {
+		fen[length++] = '-';
+	}
+	for (int z = 0; z < CASTLING_MOVES; z++) {
+		if (position->castlingRights & (1 << z)) {
+			fen[length++] = CASTLING_CHARS[z];
+		}
+	}
+	fen[length++] = ' ';
+	if (position->enPassantSquare >= 0) {
+		length += sprintf(fen + length, "%c%d", FIRST_COL + position->enPassantSquare % SIZE,
+			SIZE - position->enPassantSquare / SIZE);
+	}
+	else {
+		fen[length++] = '-';
+	}
+	length += sprintf(fen + length, " %d %d", position->halfmoveClock, position->fullmoveNumber);
+	return length;
+}
+
+/*************************************************************************************************
+*	Function name: fenToBoard
+*	Input: const char fen[], int length, char board[][SIZE]
+*	Output: int (FEN_OK or error code)
+*	Function Operation: the function fills 2D array board according to the pieces placement of the
+*	first length chars of fen (the whole NUL terminated string if length is negative). the board
+*	is filled with EMPTY at once by fillEmptySquares(), so digit only skips its squares, and any
+*	piece char is copied to its square. the placement is validated like in parseFen().
+***************************************************************************************************/
+int fenToBoard(const char fen[], int length, char board[][SIZE]) {
+
+	char* squares = &board[0][0];
+	int square = 0;
+	int rowEnd = SIZE;
+
+	if (length < 0) {
+		length = (int)strlen(fen);
+	}
+
+	fillEmptySquares(squares);
+
+	for (int c = 0; c < length && fen[c] != ' ' && fen[c] != '\0'; c++) {
+		if (fen[c] == SEP[0]) {
+			if (square != rowEnd) {
+				return FEN_BAD_ROW;
+			}
+			if (rowEnd == SQUARES) {
+				return FEN_BAD_ROWS_COUNT;
+			}
+			rowEnd += SIZE;
+		}
+		else if (fen[c] >= '1' && fen[c] <= '9') {
+			square += toDigit(fen[c]);
+			if (square > rowEnd) {
+				return FEN_BAD_ROW;
+			}
+		}
+		else {
+			if (pieceTypeFromChar(fen[c]) < 0 || !isalpha((unsigned char)fen[c])) {
+				return FEN_BAD_PIECE;
+			}
+			if (square >= rowEnd) {
+				return FEN_BAD_ROW;
+			}
+			squares[square++] = fen[c];
+		}
+	}
+
+	if (square != rowEnd) {
+		return FEN_BAD_ROW;
+	}
+	return rowEnd == SQUARES ? FEN_OK : FEN_BAD_ROWS_COUNT;
+}
+
+/*************************************************************************************************
+*	Function name: benchmarkFenConversion
+*	Input: const char fen[], int iterations
+*	Output: None
+*	Function Operation: the function measures the conversions of fen by fenToBoard(), boardToFen(),
+*	createPosition() and positionToFen(), any of them iterations times, and prints the positions
+*	per second of any conversion.
+***************************************************************************************************/
+void benchmarkFenConversion(const char fen[], int iterations) {
+
+	char board[SIZE][SIZE];
+	char text[FEN_MAX_LENGTH];
+	Position position;
+	long checksum = 0;
+	double startTime;
+
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		checksum += fenToBoard(fen, -1, board) + board[z % SIZE][0];
+	}
+	printf("fenToBoard: %.0f positions/second\n", iterations / (currentSeconds() - startTime));
+
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		board[0][z % SIZE] ^= (char)(z & 1);
+		checksum += boardToFen(board, text);
+	}
+	printf("boardToFen: %.0f positions/second\n", iterations / (currentSeconds() - startTime));
+
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		checksum += createPosition(&position, fen) + position.isWhiteTurn;
+	}
+	printf("createPosition: %.0f positions/second\n", iterations / (currentSeconds() - startTime));
+
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		position.isWhiteTurn = z & 1;
+		checksum += positionToFen(&position, text);
+	}
+	printf("positionToFen: %.0f positions/second\n", iterations / (currentSeconds() - startTime));
+	printf("Checksum: %ld\n", checksum);
+}
+
+
+//transposition table
+
+
+/*************************************************************************************************
+*	Function name: initTranspositionTable
+*	Input: TranspositionTable* table, size_t bytes
+*	Output: int (0 or 1)
+*	Function Operation: the function allocates transposition table in memory budget of bytes.
+*	half of the budget is for legality buckets and half for moves entries, and any part gets the
+*	largest power of two entries which fit in it (at least one). the memory is aligned to cache
+*	line, so any bucket is read in single cache line. 1 return if the memory was allocated,
+*	otherwise 0 and the table is empty.
+***************************************************************************************************/
+int initTranspositionTable(TranspositionTable* table, size_t bytes) {
+
+	size_t buckets = 1;
+	size_t movesEntries = 1;
+
+	while (buckets * 2 * sizeof(LegalityBucket) <= bytes / 2) {
+		buckets *= 2;
+	}
+	while (movesEntries * 2 * sizeof(MovesEntry) <= bytes / 2) {
+		movesEntries *= 2;
+	}
+
+	size_t bucketsBytes = buckets * sizeof(LegalityBucket);
+	table->memory = malloc(bucketsBytes + movesEntries * sizeof(MovesEntry) + CACHE_LINE_SIZE);
+	if (table->memory == NULL) {
+		table->buckets = NULL;
+		table->movesEntries = NULL;
+		return 0;
+	}
+
+	char* aligned = (char*)table->memory + CACHE_LINE_SIZE - (size_t)table->memory % CACHE_LINE_SIZE;
+	table->buckets = (LegalityBucket*)aligned;
+	table->movesEntries = (MovesEntry*)(aligned + bucketsBytes);
+	table->bucketsMask = buckets - 1;
+	table->movesMask = movesEntries - 1;
+	clearTranspositionTable(table);
+	return 1;
+}
+
+/*************************************************************************************************
+*	Function name: clearTranspositionTable
+*	Input: TranspositionTable* table
+*	Output: None
+*	Function Operation: the function removes all the entries of transposition table and resets
+*	its counters. it must not be called while other threads use the table.
+***************************************************************************************************/
+void clearTranspositionTable(TranspositionTable* table) {
+	memset(table->buckets, 0, (table->bucketsMask + 1) * sizeof(LegalityBucket));
+	memset(table->movesEntries, 0, (table->movesMask + 1) * sizeof(MovesEntry));
+	table->hits = 0;
+	table->misses = 0;
+}
+
+/*************************************************************************************************
+*	Function name: freeTranspositionTable
+*	Input: TranspositionTable* table
+*	Output: None
+*	Function Operation: the function frees the memory of transposition table.
+***************************************************************************************************/
+void freeTranspositionTable(TranspositionTable* table) {
+	free(table->memory);
+	table->memory = NULL;
+	table->buckets = NULL;
+	table->movesEntries = NULL;
+}
+
+/*************************************************************************************************
+*	Function name: countTableProbe
+*	Input: TranspositionTable* table, int isHit
+*	Output: None
+*	Function Operation: the function counts probe of transposition table as hit or as miss. with
+*	threads support the counters are atomic, and only their total matters, so the order of the
+*	increments is relaxed.
+***************************************************************************************************/
+void countTableProbe(TranspositionTable* table, int isHit) {
+#if THREADS_SUPPORT
+	atomic_fetch_add_explicit(isHit ? &table->hits : &table->misses, 1, memory_order_relaxed);
+#else
+	if (isHit) {
+		table->hits++;
+	}
+	else {
+		table->misses++;
+	}
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: moveTextHash
+*	Input: const char pgn[], int length
+*	Output: HashKey
+*	Function Operation: the function returns FNV-1a hash of the length chars of PGN move text,
+*	which is mixed with the position key for the legality lookup. the whole text is hashed,
+*	so moves which differ only by check or capture signs have different entries.
+***************************************************************************************************/
+HashKey moveTextHash(const char pgn[], int length) {
+
+	HashKey hash = 0xCBF29CE484222325ULL;
+
+	for (int c = 0; c < length; c++) {
+		hash = (hash ^ (unsigned char)pgn[c]) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+/*************************************************************************************************
+*	Function name: probeMoveLegality
+*	Input: TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove* move
+*	Output: int (MOVE_ILLEGAL, MOVE_LEGAL or MOVE_STALEMATE, -1 not cached)
+*	Function Operation: the function looks for legality entry of the position key and the move
+*	text hash in the bucket of their lookup key. the check and the data of any entry are read once,
+*	and entry matches only if their XOR is the lookup key and the data holds the high half of the
+*	position key, so entry which is written by other thread in the same time, or entry of other
+*	position and text with the same lookup key, is missed. in case of legal move, the encoded move
+*	is returned in move.
+***************************************************************************************************/
+int probeMoveLegality(TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove* move) {
+
+	HashKey key = positionKey ^ textHash;
+	LegalityBucket* bucket = &table->buckets[key & table->bucketsMask];
+
+	for (int z = 0; z < LEGALITY_BUCKET_SIZE; z++) {
+		HashKey check = bucket->entries[z].check;
+		HashKey data = bucket->entries[z].data;
+		if ((check ^ data) == key && (data & CACHED_POSITION_MASK) == (positionKey & CACHED_POSITION_MASK)) {
+			countTableProbe(table, 1);
+			*move = (EncodedMove)data;
+			if (!(data & CACHED_MOVE_LEGAL)) {
+				return MOVE_ILLEGAL;
+			}
+			return (data & CACHED_MOVE_STALEMATE) ? MOVE_STALEMATE : MOVE_LEGAL;
+		}
+	}
+	countTableProbe(table, 0);
+	return -1;
+}
+
+/*************************************************************************************************
+*	Function name: storeMoveLegality
+*	Input: TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove move,
+*		int result
+*	Output: None
+*	Function Operation: the function stores the result of move (see makePositionMove()) of the
+*	position key and the move text hash in the bucket of their lookup key: instead of the entry of the same lookup key or in the
+*	empty entry if exist, otherwise instead of the entry which is chosen by the high bits of the
+*	key, so the replacements are spread on the entries of bucket.
+***************************************************************************************************/
+void storeMoveLegality(TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove move, int result) {
+
+	HashKey key = positionKey ^ textHash;
+	LegalityBucket* bucket = &table->buckets[key & table->bucketsMask];
+	HashKey data = move | (result != MOVE_ILLEGAL ? CACHED_MOVE_LEGAL : 0) | (result == MOVE_STALEMATE ? CACHED_MOVE_STALEMATE : 0)
+		| (positionKey & CACHED_POSITION_MASK);
+	int slot = (int)(key >> 62) % LEGALITY_BUCKET_SIZE;
+
+	for (int z = 0; z < LEGALITY_BUCKET_SIZE; z++) {
+		HashKey check = bucket->entries[z].check;
+		HashKey entryData = bucket->entries[z].data;
+		if ((check == 0 && entryData == 0) || (check ^ entryData) == key) {
+			slot = z;
+			break;
+		}
+	}
+	bucket->entries[slot].check = key ^ data;
+	bucket->entries[slot].data = data;
+}
+
+/*************************************************************************************************
+*	Function name: movesChecksum
+*	Input: const EncodedMove moves[], int count
+*	Output: HashKey
+*	Function Operation: the function returns checksum of count and of the moves of moves entry.
+*	any move changes all the next steps, so torn entry gets different checksum.
+***************************************************************************************************/
+HashKey movesChecksum(const EncodedMove moves[], int count) {
+
+	HashKey checksum = (HashKey)count * 0x9E3779B97F4A7C15ULL;
+
+	for (int z = 0; z < count; z++) {
+		checksum = (checksum ^ moves[z]) * 0xBF58476D1CE4E5B9ULL;
+		checksum ^= checksum >> 29;
+	}
+	return checksum;
+}
+
+/*************************************************************************************************
+*	Function name: cachedLegalMoves
+*	Input: TranspositionTable* table, Position* position, MoveList* list
+*	Output: int (number of legal moves)
+*	Function Operation: the function fills list with the legal moves of position. the moves entry
+*	of the position key is copied and used if its check is the key XOR the checksum of the copy.
+*	otherwise the moves are generated by generateLegalMoves() and stored (if they fit in entry).
+***************************************************************************************************/
+int cachedLegalMoves(TranspositionTable* table, Position* position, MoveList* list) {
+
+	MovesEntry* entry = &table->movesEntries[position->key & table->movesMask];
+	MovesEntry copy = *entry;
+
+	if (copy.count <= CACHED_MOVES && (copy.check ^ movesChecksum(copy.moves, copy.count)) == position->key) {
+		countTableProbe(table, 1);
+		memcpy(list->moves, copy.moves, sizeof(EncodedMove) * copy.count);
+		list->count = copy.count;
+		return list->count;
+	}
+	countTableProbe(table, 0);
+
+	generateLegalMoves(position, list);
+	if (list->count <= CACHED_MOVES) {
+		memcpy(copy.moves, list->moves, sizeof(EncodedMove) * list->count);
+		copy.count = (unsigned short)list->count;
+		copy.check = position->key ^ movesChecksum(copy.moves, copy.count);
+		*entry = copy;
+	}
+	return list->count;
+}
+
+/*************************************************************************************************
+*	Function name: isCachedMoveLegal
+*	Input: TranspositionTable* table, Position* position, EncodedMove move
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if the cached move is one of the legal moves of
+*	position by cachedLegalMoves(), otherwise 0. the position is repeated whenever its legality
+*	entry is hit, so its legal moves are usually cached too, and move which can't be made on the
+*	position is never passed to doMove().
+***************************************************************************************************/
+int isCachedMoveLegal(TranspositionTable* table, Position* position, EncodedMove move) {
+
+	MoveList list;
+	int count = cachedLegalMoves(table, position, &list);
+
+	for (int z = 0; z < count; z++) {
+		if (list.moves[z] == move) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: makeCachedMove
+*	Input: TranspositionTable* table, Position* position, const char pgn[], int length
+*	Output: int (MOVE_ILLEGAL, MOVE_LEGAL or MOVE_STALEMATE)
+*	Function Operation: the function is the same as makePositionMove(), with transposition table.
+*	if the legality of the move text on the position is cached, the cached move is made by
+*	doMove() without parsing and checking it again, after isCachedMoveLegal() confirmed that it is
+*	legal move of the position. otherwise the move is validated by initMove() and
+*	testCheckConditions(), and the result is stored. if table is NULL, makePositionMove() is called.
+***************************************************************************************************/
+int makeCachedMove(TranspositionTable* table, Position* position, const char pgn[], int length) {
+
+	UndoInfo undo;
+	EncodedMove encoded = NULL_MOVE;
+	Move move;
+
+	if (table == NULL) {
+		return makePositionMove(position, pgn, length);
+	}
+
+	HashKey textHash = moveTextHash(pgn, length);
+	int result = probeMoveLegality(table, position->key, textHash, &encoded);
+
+	if (result > MOVE_ILLEGAL && !isCachedMoveLegal(table, position, encoded)) {
+		result = -1;
+	}
+
+	if (result < 0) {
+		initMove(position, pgn, length, &move);
+		if (move.isLegal) {
+			testCheckConditions(position, &move);
+		}
+		result = !move.isLegal ? MOVE_ILLEGAL : move.isStalemate ? MOVE_STALEMATE : MOVE_LEGAL;
+		if (move.isLegal) {
+			encoded = encodeAnnotatedMove(&move);
+		}
+		storeMoveLegality(table, position->key, textHash, encoded, result);
+	}
+
+	if (result != MOVE_ILLEGAL) {
+		doMove(position, encoded, &undo);
+	}
+	return result;
+}
+
+/*************************************************************************************************
+*	Function name: printTableCounters
+*	Input: TranspositionTable* table, FILE* report
+*	Output: None
+*	Function Operation: the function writes the hits and misses of transposition table and the
+*	hit rate to report.
+***************************************************************************************************/
+void printTableCounters(TranspositionTable* table, FILE* report) {
+
+	unsigned long hits = table->hits;
+	unsigned long misses = table->misses;
+	unsigned long probes = hits + misses;
+
+	fprintf(report, "Table hits: %lu, misses: %lu, hit rate: %.1f%%\n", hits, misses,
+		probes ? 100.0 * hits / probes : 0.0);
+}
+
+
+//game state
+
+
+/*************************************************************************************************
+*	Function name: recordGamePosition
+*	Input: GameState* game
+*	Output: None
+*	Function Operation: the function records the current position of game in the history of its
+*	ply. the previous occurrences are searched only in the positions of the same side to move
+*	since the last irreversible move (by the halfmove clock), from the last one backward. the first
+*	match already holds the number of the earlier occurrences, so the search stops on it.
+***************************************************************************************************/
+void recordGamePosition(GameState* game) {
+
+	HashKey key = game->position.key;
+	int index = game->ply % GAME_HISTORY_SIZE;
+	int repetitions = 1;
+
+	for (int back = 2; back <= game->position.halfmoveClock && back < GAME_HISTORY_SIZE && back <= game->ply; back += 2) {
+		int previous = (game->ply - back) % GAME_HISTORY_SIZE;
+		if (game->keys[previous] == key) {
+			repetitions = game->repetitions[previous] + 1;
+			break;
+		}
+	}
+
+	game->keys[index] = key;
+	game->repetitions[index] = (unsigned char)(repetitions < 255 ? repetitions : 255);
+}
+
+/*************************************************************************************************
+*	Function name: createGameState
+*	Input: GameState* game, const char fen[]
+*	Output: int (FEN_OK or error code)
+*	Function Operation: the function creates game from FEN by createPosition() (with the clocks of
+*	FEN). the history starts with the position of FEN. in case of invalid FEN, the error code return.
+***************************************************************************************************/
+int createGameState(GameState* game, const char fen[]) {
+
+	int error = createPosition(&game->position, fen);
+
+	game->ply = 0;
+	recordGamePosition(game);
+	return error;
+}
+
+/*************************************************************************************************
+*	Function name: playGameMove
+*	Input: GameState* game, TranspositionTable* table, const char pgn[], int length
+*	Output: int (MOVE_ILLEGAL, MOVE_LEGAL or MOVE_STALEMATE)
+*	Function Operation: the function makes PGN move on the position of game by makeCachedMove()
+*	(table may be NULL), which updates the clocks of the position, and returns its result. in case
+*	of legal move, the new position is recorded. in case of illegal move the game is not changed.
+***************************************************************************************************/
+int playGameMove(GameState* game, TranspositionTable* table, const char pgn[], int length) {
+
+	int result = makeCachedMove(table, &game->position, pgn, length);
+
+	if (result == MOVE_ILLEGAL) {
+		return MOVE_ILLEGAL;
+	}
+
+	game->ply++;
+	recordGamePosition(game);
+	return result;
+}
+
+/*************************************************************************************************
+*	Function name: repetitionCount
+*	Input: GameState* game
+*	Output: int
+*	Function Operation: the function returns how many times the current position of game occurred
+*	(1 for the first time), as it was recorded by recordGamePosition().
+***************************************************************************************************/
+int repetitionCount(GameState* game) {
+	return game->repetitions[game->ply % GAME_HISTORY_SIZE];
+}
+
+/*************************************************************************************************
+*	Function name: isThreefoldRepetition
+*	Input: GameState* game
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if the current position of game occurred at least
+*	three times, otherwise 0.
+***************************************************************************************************/
+int isThreefoldRepetition(GameState* game) {
+	return repetitionCount(game) >= 3;
+}
+
+/*************************************************************************************************
+*	Function name: isFiftyMoveRule
+*	Input: GameState* game
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if fifty moves of any side were made without pawn
+*	move or capture, otherwise 0.
+***************************************************************************************************/
+int isFiftyMoveRule(GameState* game) {
+	return game->position.halfmoveClock >= FIFTY_MOVES_PLIES;
+}
+
+/*************************************************************************************************
+*	Function name: canClaimDraw
+*	Input: GameState* game
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if draw can be claimed in the current position of
+*	game, by threefold repetition or by fifty-move rule, otherwise 0.
+***************************************************************************************************/
+int canClaimDraw(GameState* game) {
+	return isThreefoldRepetition(game) || isFiftyMoveRule(game);
+}
+
+
+//search
+
+
+/*************************************************************************************************
+*	Function name: evaluatePosition
+*	Input: Position* position
+*	Output: int (score in centipawns)
+*	Function Operation: the function returns the static score of position for the side to move:
+*	the middlegame and endgame scores of the pieces values and squares, which are weighted by the
+*	phase of position - full middlegame score with all the pieces, and full endgame score without
+*	Knights, Bishops, Rooks and Queens. the terms are kept in position by placePiece() and
+*	removePiece(), so doMove() and undoMove() update them and the cost doesn't depend on the board.
+*	if network is loaded, the score is evaluated by the network instead.
+***************************************************************************************************/
+int evaluatePosition(Position* position) {
+
+	if (nnueNetwork.memory != NULL) {
+		return evaluateNnue(position);
+	}
+
+	int phase = position->phase < TOTAL_PHASE ? position->phase : TOTAL_PHASE;
+	int score = (position->middlegameScore * phase + position->endgameScore * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+
+	return position->isWhiteTurn ? score : -score;
+}
+
+/*************************************************************************************************
+*	Function name: isCaptureMove
+*	Input: Position* position, EncodedMove move
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if the move of the side to move captures piece -
+*	its destination is occupied, or it is en passant capture - otherwise 0.
+***************************************************************************************************/
+int isCaptureMove(Position* position, EncodedMove move) {
+	return position->mailbox[moveDest(move)] != NO_PIECE || (move >> 12) == MOVE_EN_PASSANT;
+}
+
+/*************************************************************************************************
+*	Function name: scoreSearchMoves
+*	Input: SearchState* state, Position* position, MoveList* list, int ply, EncodedMove tableMove,
+*		int scores[]
+*	Output: None
+*	Function Operation: the function gives order score to any move of list, so the moves which
+*	probably cause cutoff are searched first: the best move of search table (tableMove, 0 if none),
+*	the move of the previous principal variation in ply, then captures by the value of the captured
+*	piece (and then by the cheaper capturing piece), promotions, the killer moves of ply and the
+*	other quiet moves.
+***************************************************************************************************/
+void scoreSearchMoves(SearchState* state, Position* position, MoveList* list, int ply, EncodedMove tableMove,
+	int scores[]) {
+
+	EncodedMove pvMove = ply < state->previousPvLength ? state->previousPv[ply] : 0;
+
+	for (int z = 0; z < list->count; z++) {
+		EncodedMove move = list->moves[z];
+		int promotionType = movePromotionType(move);
+
+		if (move == tableMove) {
+			scores[z] = 1 << 21;
+		}
+		else if (move == pvMove) {
+			scores[z] = 1 << 20;
+		}
+		else if (isCaptureMove(position, move)) {
+			int captured = position->mailbox[moveDest(move)];
+			int victim = captured == NO_PIECE ? PAWN_TYPE : captured % PIECE_TYPES;
+			scores[z] = (1 << 16) + PIECE_VALUES[victim] * 8 - position->mailbox[moveSrc(move)] % PIECE_TYPES;
+		}
+		else if (promotionType >= 0) {
+			scores[z] = (1 << 15) + PIECE_VALUES[promotionType];
+		}
+		else if (move == state->killers[ply][0]) {
+			scores[z] = 1 << 14;
+		}
+		else if (move == state->killers[ply][1]) {
+			scores[z] = (1 << 14) - 1;
+		}
+		else {
+			scores[z] = 0;
+		}
+	}
+}
+
+/*************************************************************************************************
+*	Function name: pickSearchMove
+*	Input: MoveList* list, int scores[], int index
+*	Output: EncodedMove
+*	Function Operation: the function swaps the move with the best order score from index to the end
+*	of list into index, and returns it. the moves are sorted only as far as they are searched,
+*	because after cutoff the rest of moves is not needed.
+***************************************************************************************************/
+EncodedMove pickSearchMove(MoveList* list, int scores[], int index) {
+
+	int best = index;
+
+	for (int z = index + 1; z < list->count; z++) {
+		if (scores[z] > scores[best]) {
+			best = z;
+		}
+	}
+
+	EncodedMove move = list->moves[best];
+	int score = scores[best];
+	list->moves[best] = list->moves[index];
+	scores[best] = scores[index];
+	list->moves[index] = move;
+	scores[index] = score;
+	return move;
+}
+
+/*************************************************************************************************
+*	Function name: addSearchNodes
+*	Input: SearchShared* shared, unsigned long long nodes
+*	Output: unsigned long long (total nodes)
+*	Function Operation: the function adds nodes of thread to the shared nodes of search, and
+*	returns the total. with threads support the counter is atomic, with relaxed order.
+***************************************************************************************************/
+unsigned long long addSearchNodes(SearchShared* shared, unsigned long long nodes) {
+#if THREADS_SUPPORT
+	return atomic_fetch_add_explicit(&shared->nodes, nodes, memory_order_relaxed) + nodes;
+#else
+	return shared->nodes += nodes;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: isSharedSearchStopped
+*	Input: SearchShared* shared
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if any thread stopped the search, otherwise 0.
+***************************************************************************************************/
+int isSharedSearchStopped(SearchShared* shared) {
+#if THREADS_SUPPORT
+	return atomic_load_explicit(&shared->isStopped, memory_order_relaxed);
+#else
+	return shared->isStopped;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: stopSharedSearch
+*	Input: SearchShared* shared
+*	Output: None
+*	Function Operation: the function stops all the threads of search, which see the flag in their
+*	next check by isSearchStopped().
+***************************************************************************************************/
+void stopSharedSearch(SearchShared* shared) {
+#if THREADS_SUPPORT
+	atomic_store_explicit(&shared->isStopped, 1, memory_order_relaxed);
+#else
+	shared->isStopped = 1;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: isSearchStopped
+*	Input: SearchState* state
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if the search has to stop because its budget is
+*	over or other thread stopped it. the nodes of thread are added to the shared nodes once in
+*	SEARCH_CHECK_NODES nodes, or in any node when the known total is near the nodes budget (so the
+*	budget is exact in single thread), and only then the shared flag, the nodes budget and the time
+*	are checked. once the search is stopped, it remains stopped.
+***************************************************************************************************/
+int isSearchStopped(SearchState* state) {
+
+	unsigned long long pending = state->nodes - state->reportedNodes;
+
+	if (state->isStopped) {
+		return 1;
+	}
+	if (pending < SEARCH_CHECK_NODES && (!state->limits.maxNodes || state->knownNodes + pending < state->limits.maxNodes)) {
+		return 0;
+	}
+
+	state->knownNodes = addSearchNodes(state->shared, pending);
+	state->reportedNodes = state->nodes;
+	if (isSharedSearchStopped(state->shared)) {
+		state->isStopped = 1;
+	}
+	else if ((state->limits.maxNodes && state->knownNodes >= state->limits.maxNodes)
+		|| (state->limits.maxSeconds > 0 && currentSeconds() - state->startTime >= state->limits.maxSeconds)) {
+		stopSharedSearch(state->shared);
+		state->isStopped = 1;
+	}
+	return state->isStopped;
+}
+
+/*************************************************************************************************
+*	Function name: isSearchDraw
+*	Input: SearchState* state, Position* position, int ply
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if position in ply of search is draw by fifty-move
+*	rule, or it repeats position of the same side to move since the last irreversible move, on the
+*	path from root or in the game before root. single repetition is enough, because the side which
+*	repeats could repeat again.
+***************************************************************************************************/
+int isSearchDraw(SearchState* state, Position* position, int ply) {
+
+	int index = state->rootIndex + ply;
+
+	if (position->halfmoveClock >= FIFTY_MOVES_PLIES) {
+		return 1;
+	}
+	for (int back = 4; back <= position->halfmoveClock && back <= index; back += 2) {
+		if (state->keys[index - back] == position->key) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*************************************************************************************************
+*	Function name: quiescenceSearch
+*	Input: SearchState* state, Position* position, int ply, int alpha, int beta
+*	Output: int (score)
+*	Function Operation: the function searches only captures and promotions at the end of the
+*	alpha-beta search, so the static score is not taken in the middle of exchange. the side to
+*	move may stand on the static score, unless it is in check - then all the legal moves are
+*	searched, and without legal move it is mated.
+***************************************************************************************************/
+int quiescenceSearch(SearchState* state, Position* position, int ply, int alpha, int beta) {
+
+	MoveList list;
+	UndoInfo undo;
+	int scores[MAX_MOVES];
+	int isInCheck = position->checkers != 0;
+	int best = -INFINITE_SCORE;
+
+	state->nodes++;
+	if (isSearchStopped(state)) {
+		return 0;
+	}
+	if (ply >= SEARCH_MAX_PLY) {
+		return evaluatePosition(position);
+	}
+
+	if (!isInCheck) {
+		best = evaluatePosition(position);
+		if (best >= beta) {
+			return best;
+		}
+		if (best > alpha) {
+			alpha = best;
+		}
+	}
+
+	generateLegalMoves(position, &list);
+	if (isInCheck && list.count == 0) {
+		return -MATE_SCORE + ply;
+	}
+
+	scoreSearchMoves(state, position, &list, ply, 0, scores);
+	for (int z = 0; z < list.count; z++) {
+		EncodedMove move = pickSearchMove(&list, scores, z);
+		if (!isInCheck && !isCaptureMove(position, move) && movePromotionType(move) < 0) {
+			continue;
+		}
+
+		doMove(position, move, &undo);
+		int score = -quiescenceSearch(state, position, ply + 1, -beta, -alpha);
+		undoMove(position, &undo);
+
+		if (state->isStopped) {
+			return 0;
+		}
+		if (score > best) {
+			best = score;
+			if (score > alpha) {
+				alpha = score;
+				if (score >= beta) {
+					break;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+/*************************************************************************************************
+*	Function name: alphaBetaSearch
+*	Input: SearchState* state, Position* position, int depth, int ply, int alpha, int beta
+*	Output: int (score)
+*	Function Operation: the function returns the score of position in negamax form - the score of
+*	any move is the negative score of the opponent after it - and searches only the scores inside
+*	the window (alpha, beta). the moves are the legal moves of generateLegalMoves() and they are
+*	performed by doMove(), like the moves of PGN games.
+*	(1) draw by repetition or fifty-move rule is scored 0, and on depth 0 quiescenceSearch() ends.
+*	(2) entry of search table (if there is table) in the same depth at least ends null window
+*		search by its bound, and its best move is searched first anyway.
+*	(3) without legal moves, the side to move is mated (in check) or it is stalemate.
+*	(4) the side in check gets one ply more, so check sequences are not cut in the middle.
+*	(5) the first move is searched with the full window, and any other move first with null window
+*		(principal variation search), and again with the full window only if it is better.
+*	(6) the best move in the window is kept in the principal variation table with the line after
+*		it, and quiet move which causes cutoff is kept as killer move of ply. the best move and
+*		its score are stored in search table with the bound by the window.
+***************************************************************************************************/
+int alphaBetaSearch(SearchState* state, Position* position, int depth, int ply, int alpha, int beta) {
+
+	MoveList list;
+	UndoInfo undo;
+	int scores[MAX_MOVES];
+	int best = -INFINITE_SCORE;
+	int originalAlpha = alpha;
+	int originalDepth = depth;
+	EncodedMove tableMove = 0;
+	EncodedMove bestMove = 0;
+
+	state->pvLength[ply] = ply;
+	if (ply > 0 && isSearchDraw(state, position, ply)) {
+		return 0;
+	}
+	if (depth <= 0 || ply >= SEARCH_MAX_PLY) {
+		return quiescenceSearch(state, position, ply, alpha, beta);
+	}
+
+	state->nodes++;
+	if (isSearchStopped(state)) {
+		return 0;
+	}
+
+	if (state->table != NULL) {
+		int tableScore, tableDepth, bound;
+		if (probeSearchTable(state->table, position->key, &tableMove, &tableScore, &tableDepth, &bound)
+			&& ply > 0 && beta - alpha == 1 && tableDepth >= depth) {
+			tableScore = scoreFromTable(tableScore, ply);
+			if (bound == BOUND_EXACT || (bound == BOUND_LOWER && tableScore >= beta)
+				|| (bound == BOUND_UPPER && tableScore <= alpha)) {
+				return tableScore;
+			}
+		}
+	}
+
+	generateLegalMoves(position, &list);
+	if (list.count == 0) {
+		return position->checkers ? -MATE_SCORE + ply : 0;
+	}
+	if (position->checkers) {
+		depth++;
+	}
+
+	scoreSearchMoves(state, position, &list, ply, tableMove, scores);
+	for (int z = 0; z < list.count; z++) {
+		EncodedMove move = pickSearchMove(&list, scores, z);
+		int score;
+
+		doMove(position, move, &undo);
+		state->keys[state->rootIndex + ply + 1] = position->key;
+		if (z == 0) {
+			score = -alphaBetaSearch(state, position, depth - 1, ply + 1, -beta, -alpha);
+		}
+		else {
+			score = -alphaBetaSearch(state, position, depth - 1, ply + 1, -alpha - 1, -alpha);
+			if (score > alpha && score < beta) {
+				score = -alphaBetaSearch(state, position, depth - 1, ply + 1, -beta, -alpha);
+			}
+		}
+		undoMove(position, &undo);
+
+		if (state->isStopped) {
+			return 0;
+		}
+		if (score <= best) {
+			continue;
+		}
+		best = score;
+		bestMove = move;
+		if (score > alpha) {
+			alpha = score;
+
+			// The line of the best move is the move and the line of the next ply
+			state->pv[ply][ply] = move;
+			for (int next = ply + 1; next < state->pvLength[ply + 1]; next++) {
+				state->pv[ply][next] = state->pv[ply + 1][next];
+			}
+			state->pvLength[ply] = state->pvLength[ply + 1];
+
+			if (score >= beta) {
+				if (!isCaptureMove(position, move) && move != state->killers[ply][0]) {
+					state->killers[ply][1] = state->killers[ply][0];
+					state->killers[ply][0] = move;
+				}
+				break;
+			}
+		}
+	}
+
+	if (state->table != NULL) {
+		int bound = best >= beta ? BOUND_LOWER : (best > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+		storeSearchTable(state->table, position->key, bestMove, scoreToTable(best, ply), originalDepth, bound);
+	}
+	return best;
+}
+
+/*************************************************************************************************
+*	Function name: iterativeDeepening
+*	Input: SearchState* state, Position* position, SearchResult* result
+*	Output: int (0 or 1)
+*	Function Operation: the function searches position by alphaBetaSearch() in depth 1, 2, 3 and
+*	so on until the maximum depth or the end of the budget. any iteration starts by the principal
+*	variation of the previous one, so the most of the tree is cut early.
+*	from depth 2 the window is ASPIRATION_WINDOW around the previous score, and when the score
+*	falls outside it, it is widened twice and the search is repeated. the result is the line of
+*	the last iteration which was completed (or the first legal move if none). helper thread of
+*	parallel search (id which is not 0) starts in depth 2 if its id is odd, so the helpers search
+*	different depths together and fill the shared table for each other. 1 return if there is legal
+*	move in position, otherwise 0.
+***************************************************************************************************/
+int iterativeDeepening(SearchState* state, Position* position, SearchResult* result) {
+
+	MoveList list;
+	int maxDepth = state->limits.maxDepth > 0 && state->limits.maxDepth < SEARCH_MAX_PLY
+		? state->limits.maxDepth : SEARCH_MAX_PLY - 1;
+
+	generateLegalMoves(position, &list);
+	result->bestMove = list.count > 0 ? list.moves[0] : 0;
+	result->score = list.count > 0 ? 0 : (position->checkers ? -MATE_SCORE : 0);
+	result->depth = 0;
+	result->pvLength = 0;
+
+	for (int depth = 1 + state->id % 2; depth <= maxDepth && list.count > 0; depth++) {
+		int window = ASPIRATION_WINDOW;
+		int alpha = depth > 1 ? result->score - window : -INFINITE_SCORE;
+		int beta = depth > 1 ? result->score + window : INFINITE_SCORE;
+		int score;
+
+		while (1) {
+			score = alphaBetaSearch(state, position, depth, 0, alpha, beta);
+			if (state->isStopped) {
+				break;
+			}
+			window *= 2;
+			if (score <= alpha) {
+				alpha = score - window > -INFINITE_SCORE ? score - window : -INFINITE_SCORE;
+			}
+			else if (score >= beta) {
+				beta = score + window < INFINITE_SCORE ? score + window : INFINITE_SCORE;
+			}
+			else {
+				break;
+			}
+		}
+		if (state->isStopped) {
+			break;
+		}
+
+		result->score = score;
+		result->depth = depth;
+		result->pvLength = state->pvLength[0];
+		for (int ply = 0; ply < result->pvLength; ply++) {
+			result->pv[ply] = state->previousPv[ply] = state->pv[0][ply];
+		}
+		state->previousPvLength = result->pvLength;
+		result->bestMove = result->pvLength > 0 ? result->pv[0] : result->bestMove;
+
+		// Mate which is found can't be shorter in deeper search
+		if (score >= MATE_SCORE - depth || score <= -MATE_SCORE + depth) {
+			break;
+		}
+	}
+
+	addSearchNodes(state->shared, state->nodes - state->reportedNodes);
+	state->reportedNodes = state->nodes;
+	result->nodes = state->nodes;
+	result->seconds = currentSeconds() - state->startTime;
+	return list.count > 0;
+}
+
+/*************************************************************************************************
+*	Function name: initSearchTable
+*	Input: SearchTable* table, size_t bytes
+*	Output: int (0 or 1)
+*	Function Operation: the function allocates search table with the largest power of two buckets
+*	which fit in memory budget of bytes (at least one). the memory is aligned to cache line, so
+*	any bucket is read in single cache line. 1 return if the memory was allocated, otherwise 0 and
+*	the table is empty.
+***************************************************************************************************/
+int initSearchTable(SearchTable* table, size_t bytes) {
+
+	size_t buckets = 1;
 
-		}
+	while (buckets * 2 * sizeof(SearchBucket) <= bytes) {
+		buckets *= 2;
+	}
 
+	table->memory = malloc(buckets * sizeof(SearchBucket) + CACHE_LINE_SIZE);
+	if (table->memory == NULL) {
+		table->buckets = NULL;
+		return 0;
 	}
 
-	return 0;
+	table->buckets = (SearchBucket*)((char*)table->memory + CACHE_LINE_SIZE - (size_t)table->memory % CACHE_LINE_SIZE);
+	table->bucketsMask = buckets - 1;
+	clearSearchTable(table);
+	return 1;
+}
 
+/*************************************************************************************************
+*	Function name: clearSearchTable
+*	Input: SearchTable* table
+*	Output: None
+*	Function Operation: the function removes all the entries of search table. it must not be
+*	called while search uses the table.
+***************************************************************************************************/
+void clearSearchTable(SearchTable* table) {
+	memset(table->buckets, 0, (table->bucketsMask + 1) * sizeof(SearchBucket));
+	table->generation = 0;
 }
 
 /*************************************************************************************************
-*	Function name: noCaptureDestTest
-*	Input: int isCapture, char destPiece
-*	Output: int (0 or 1)
-*	Function Operation: this function recieved flag if there is capture declaration and the kind
-*	of piece which is located in destination. It may be that there is no piece in destination and it
-*	is empty. In this case, the Move is ilegal. cause there is declaration on capture but there is no
-*	piece in destination to be captured.
-*	If there is capture declarartion but there is no piece in dest - return 1
-*	else, if there is no capture declaration or there is piece in dest - return 0
+*	Function name: freeSearchTable
+*	Input: SearchTable* table
+*	Output: None
+*	Function Operation: the function frees the memory of search table.
 ***************************************************************************************************/
-int noCaptureDestTest(int isCapture, char destPiece) {
+void freeSearchTable(SearchTable* table) {
+	free(table->memory);
+	table->memory = NULL;
+	table->buckets = NULL;
+}
 
-	if (isCapture && destPiece == EMPTY) {
-		return 1;
+/*************************************************************************************************
+*	Function name: scoreToTable
+*	Input: int score, int ply
+*	Output: int (score)
+*	Function Operation: the function converts mate score of search in ply, which is counted from
+*	root, to mate score which is counted from the position itself, so it is right for the same
+*	position in any ply. other scores are not changed. scoreFromTable() converts it back.
+***************************************************************************************************/
+int scoreToTable(int score, int ply) {
+	if (score >= MATE_SCORE - SEARCH_MAX_PLY) {
+		return score + ply;
 	}
-	else {
-		return 0;
+	if (score <= -MATE_SCORE + SEARCH_MAX_PLY) {
+		return score - ply;
 	}
+	return score;
 }
 
 /*************************************************************************************************
-*	Function name: noCaptureDeclareTest
-*	Input: char destPiece, int isWhite, int isCapture
-*	Output: int (0 or 1)
-*	Function Operation: this function recieved flag if there is capture declaration, the color of turn
-*	and the kind of piece which is located in destination. if the destination is not empty, and the
-*	piece in destination is different from turn color - so capture need to be declared.
-*	If there is no capture declaration - the move is ilegal.
-*	If there is capture trial without declaration - return 1
-*	Else if there is no capture or there is declaration - return 0
+*	Function name: scoreFromTable
+*	Input: int score, int ply
+*	Output: int (score)
+*	Function Operation: the function converts mate score of search table to mate score of search
+*	in ply (see scoreToTable()).
 ***************************************************************************************************/
-int noCaptureDeclareTest(char destPiece, int isWhite, int isCapture) {
-
-	if (destPiece != EMPTY) {
+int scoreFromTable(int score, int ply) {
+	if (score >= MATE_SCORE - SEARCH_MAX_PLY) {
+		return score - ply;
+	}
+	if (score <= -MATE_SCORE + SEARCH_MAX_PLY) {
+		return score + ply;
+	}
+	return score;
+}
 
-		if (isWhite) {
-			if (!isWhiteDest(destPiece) && !(isCapture)) {
-				return 1;
-			}
-			else {
-				return 0;
-			}
+/*************************************************************************************************
+*	Function name: probeSearchTable
+*	Input: SearchTable* table, HashKey key, EncodedMove* move, int* score, int* depth, int* bound
+*	Output: int (0 or 1)
+*	Function Operation: the function looks for entry of position key in its bucket. the check and
+*	the data of any entry are read once, and entry matches only if their XOR is the key, so entry
+*	which is written by other thread in the same time is missed. in case of match, the best move,
+*	the score, the depth and the bound are returned and 1 return, otherwise 0.
+***************************************************************************************************/
+int probeSearchTable(SearchTable* table, HashKey key, EncodedMove* move, int* score, int* depth, int* bound) {
+
+	SearchBucket* bucket = &table->buckets[key & table->bucketsMask];
+
+	for (int z = 0; z < SEARCH_BUCKET_SIZE; z++) {
+		HashKey check = bucket->entries[z].check;
+		HashKey data = bucket->entries[z].data;
+		if ((check ^ data) == key && data != 0) {
+			*move = (EncodedMove)data;
+			*score = (short)(data >> 16);
+			*depth = (int)(data >> 32) & 0xFF;
+			*bound = (int)(data >> 40) & 3;
+			return 1;
 		}
-		else {
-			if (isWhiteDest(destPiece) && !(isCapture)) {
-				return 1;
-			}
-			else {
-				return 0;
-			}
+	}
+	return 0;
+}
 
+/*************************************************************************************************
+*	Function name: storeSearchTable
+*	Input: SearchTable* table, HashKey key, EncodedMove move, int score, int depth, int bound
+*	Output: None
+*	Function Operation: the function stores search result of position key in its bucket: instead
+*	of the entry of the same key if exist, otherwise instead of the entry of older search or of the
+*	lowest depth, so the deep entries of current search which save the most work are kept. without
+*	move, the move of the previous entry of the same key is kept.
+***************************************************************************************************/
+void storeSearchTable(SearchTable* table, HashKey key, EncodedMove move, int score, int depth, int bound) {
+
+	SearchBucket* bucket = &table->buckets[key & table->bucketsMask];
+	int generation = table->generation & 0xFF;
+	int slot = 0;
+	int slotValue = INFINITE_SCORE;
+
+	for (int z = 0; z < SEARCH_BUCKET_SIZE; z++) {
+		HashKey data = bucket->entries[z].data;
+		if ((bucket->entries[z].check ^ data) == key) {
+			slot = z;
+			move = move ? move : (EncodedMove)data;
+			break;
 		}
 
+		// Entry of older search is worth less than any entry of this search
+		int value = ((int)(data >> 32) & 0xFF) - (((int)(data >> 48) & 0xFF) != generation ? 256 : 0);
+		if (value < slotValue) {
+			slot = z;
+			slotValue = value;
+		}
 	}
 
-	return 0;
+	HashKey data = move | ((HashKey)(unsigned short)score << 16) | ((HashKey)(depth & 0xFF) << 32)
+		| ((HashKey)bound << 40) | ((HashKey)generation << 48);
+	bucket->entries[slot].check = key ^ data;
+	bucket->entries[slot].data = data;
 }
 
+#if THREADS_SUPPORT
 
-// Check tests
+/*************************************************************************************************
+*	Function name: runSearchWorker
+*	Input: void* argument (SearchWorker*)
+*	Output: int (0)
+*	Function Operation: the function is the thread of helper in parallel search. it searches its
+*	copy of root by iterativeDeepening() until the main thread stops the search.
+***************************************************************************************************/
+int runSearchWorker(void* argument) {
+
+	SearchWorker* worker = (SearchWorker*)argument;
+
+	iterativeDeepening(&worker->state, &worker->position, &worker->result);
+	return 0;
+}
+
+#endif
 
 /*************************************************************************************************
-*	Function name: testCheckConditions
-*	Input: char board[][SIZE], Move move
-*	Output: Move testCheckMove
-*	Function Operation: this function gathers all the tests that need to be checked in check
-*	situation. this function use sub-functions which will be described below.
-*	Description about tests:
-*	-In case of check trial without declaration, change testCheckMove.isLegal to 0 and return
-*	-In case of check declaration without trial, change testCheckMove.isLegal to 0 and return
-*	-In case of perfroming move leads to check threat, change testCheckMove.isLegal to 0 and return
-*	-In case of current check situation, that illegal move try to be done, change testCheckMove.isLegal
-* 	to 0 and return.
-*	- In any other case, return change the original testCheckMove
+*	Function name: runParallelSearch
+*	Input: SearchState* state, Position* position, int threads, SearchResult* result
+*	Output: int (0 or 1)
+*	Function Operation: the function searches position by Lazy SMP: state is the main thread, and
+*	threads - 1 helpers (the number of processors if threads is not positive) search the same
+*	root with copies of state, without any other communication than the shared search table and
+*	the shared state. the helpers find positions for each other and for the main thread in the
+*	table, so the main thread completes its iterations sooner. when the main thread completes its
+*	search, it stops the helpers, and its result is the result of search with the nodes of all the
+*	threads. without threads support or search table, the search runs in the calling thread only.
 ***************************************************************************************************/
-Move testCheckConditions(char board[][SIZE], Move move) {
+int runParallelSearch(SearchState* state, Position* position, int threads, SearchResult* result) {
 
-	Move testCheckMove = move;
+	SearchShared shared;
+	int hasMove;
 
-	if (checkTrialWithoutDeclare(board, testCheckMove, testCheckMove.isWhite, !testCheckMove.isWhite)) {
-		testCheckMove.isLegal = 0;
-		return testCheckMove;
+	shared.isStopped = 0;
+	shared.nodes = 0;
+	state->shared = &shared;
+	state->startTime = currentSeconds();
+	if (state->table != NULL) {
+		state->table->generation++;
 	}
 
-	if (checkDeclareWithoutTrial(board, testCheckMove, testCheckMove.isWhite, !testCheckMove.isWhite)) {
-		testCheckMove.isLegal = 0;
-		return testCheckMove;
+	if (threads <= 0) {
+		threads = processorsCount();
 	}
-
-	if (moveCauseToCheckThreat(board, testCheckMove, !testCheckMove.isWhite, testCheckMove.isWhite)) {
-		testCheckMove.isLegal = 0;
-		return testCheckMove;
+	if (state->table == NULL) {
+		threads = 1;
 	}
 
-	if (limitedMoveInCheckCase(board, testCheckMove, !testCheckMove.isWhite, testCheckMove.isWhite)) {
-		testCheckMove.isLegal = 0;
-		return testCheckMove;
-	}
+#if THREADS_SUPPORT
+	if (threads > 1) {
+
+		/*
+			Worker embeds cache aligned Position, so the array is aligned by hand like the search
+			table. the size of worker is multiple of cache line, so any worker is aligned.
+		*/
+		void* workersMemory = malloc(sizeof(SearchWorker) * (threads - 1) + CACHE_LINE_SIZE);
+		SearchWorker* workers = workersMemory == NULL ? NULL
+			: (SearchWorker*)((char*)workersMemory + CACHE_LINE_SIZE - (size_t)workersMemory % CACHE_LINE_SIZE);
+		thrd_t* handles = malloc(sizeof(thrd_t) * (threads - 1));
+		int* isStarted = calloc(threads - 1, sizeof(int));
+
+		if (workers != NULL && handles != NULL && isStarted != NULL) {
+			for (int w = 0; w < threads - 1; w++) {
+				workers[w].state = *state;
+				workers[w].state.id = w + 1;
+				workers[w].position = *position;
+				isStarted[w] = thrd_create(&handles[w], runSearchWorker, &workers[w]) == thrd_success;
+			}
+		}
+
+		hasMove = iterativeDeepening(state, position, result);
+		stopSharedSearch(&shared);
 
-	return testCheckMove;
+		if (workers != NULL && handles != NULL && isStarted != NULL) {
+			for (int w = 0; w < threads - 1; w++) {
+				if (isStarted[w]) {
+					thrd_join(handles[w], NULL);
+				}
+			}
+		}
+		free(workersMemory);
+		free(handles);
+		free(isStarted);
+	}
+	else
+#endif
+	{
+		hasMove = iterativeDeepening(state, position, result);
+	}
 
+#if THREADS_SUPPORT
+	result->nodes = atomic_load(&shared.nodes);
+#else
+	result->nodes = shared.nodes;
+#endif
+	result->seconds = currentSeconds() - state->startTime;
+	return hasMove;
 }
 
 /*************************************************************************************************
-*	Function name: isCheckCase
-*	Input: char board[][SIZE], int isWhiteMove, int isTheratToWhite
+*	Function name: searchPosition
+*	Input: Position* position, const SearchLimits* limits, SearchTable* table, int threads,
+*		SearchResult* result
 *	Output: int (0 or 1)
-*	Function Operation: this function receives the currnt board as 2D array, flag for color of turn,
-*	and flag for color to the threatened side. This function if there is any piece on board
-*	that can make legal move and to capture the king. if there is Move which found, it means that there
-*	is threat to king and this is check situation. If this is check case, return 1. if there is not
-*	check case, return 0.
+*	Function Operation: the function searches the best move of the side to move in position by
+*	runParallelSearch() with threads (see there), in the budget of limits. table may be NULL, then
+*	the search runs in single thread without table. the search is done on copy of position, so
+*	position is not changed. repetitions are found only on the path from position (see
+*	searchGame() for the game history). 1 return if there is legal move, otherwise 0.
 ***************************************************************************************************/
-int isCheckCase(char board[][SIZE], int isWhiteMove, int isTheratToWhite) {
+int searchPosition(Position* position, const SearchLimits* limits, SearchTable* table, int threads, SearchResult* result) {
 
-	//Variable which represents the king which may be threatened
-	char kingChar;
+	SearchState* state = malloc(sizeof(SearchState));
+	Position root = *position;
 
-	Move optionalMove;
-	Move updatedMove;
+	if (state == NULL) {
+		return 0;
+	}
+	memset(state, 0, sizeof(SearchState));
+	state->limits = *limits;
+	state->table = table;
+	state->keys[0] = root.key;
+
+	int hasMove = runParallelSearch(state, &root, threads, result);
+	free(state);
+	return hasMove;
+}
 
-	/*
-		Array which include all the optional piece which may make
-		legal move and to capture the king.
-	*/
-	char optionalSrcPiece[] = { 'R', 'B', 'N', 'Q', 'K','P' };
+/*************************************************************************************************
+*	Function name: searchGame
+*	Input: GameState* game, const SearchLimits* limits, SearchTable* table, int threads,
+*		SearchResult* result
+*	Output: int (0 or 1)
+*	Function Operation: the function is the same as searchPosition() on the current position of
+*	game, and the keys of the game history since the last irreversible move are put before root,
+*	so the search finds also repetitions of positions which occurred in the game.
+***************************************************************************************************/
+int searchGame(GameState* game, const SearchLimits* limits, SearchTable* table, int threads, SearchResult* result) {
 
+	SearchState* state = malloc(sizeof(SearchState));
+	Position root = game->position;
+	int history = root.halfmoveClock < game->ply ? root.halfmoveClock : game->ply;
 
-	// Initialize the king char according to threatened side color
-	if (isTheratToWhite) {
-		kingChar = KING;
+	if (state == NULL) {
+		return 0;
 	}
-	else {
-		kingChar = tolower(KING);
+	if (history > GAME_HISTORY_SIZE - 1) {
+		history = GAME_HISTORY_SIZE - 1;
 	}
 
-	//default optionalMove initialization
-	optionalMove.destPiece = kingChar;
-	optionalMove.isWhite = isWhiteMove;
-	optionalMove.isCapture = 1;
-
-	/*
-		For loop on the 2D array board, to locate any optional king.
-		when there is optional threatened king, there is another for loop which
-		pass on any optional piece that may threat on the king.
-		There is using findOptionalPieceByMove() in order to check if there is any
-		legal move that may be made in order to capture the king.
-		If there is legal move which found, it means that the board is in a check situation.
-	*/
-	for (int i = 0; i < SIZE; i++) {
-		for (int j = 0; j < SIZE; j++) {
-			if (board[i][j] == kingChar) {
-				for (int z = 0; z < sizeof(optionalSrcPiece); z++) {
-					optionalMove.iDest = i;
-					optionalMove.jDest = j;
-					optionalMove.iSrc = -1;
-					optionalMove.jSrc = -1;
-					optionalMove.srcPiece = optionalSrcPiece[z];
-					updatedMove = findOptionalPieceByMove(board, optionalMove);
-					if (updatedMove.isLegal) {
-						return 1;
-					}
-				}
-			}
-		}
+	memset(state, 0, sizeof(SearchState));
+	state->limits = *limits;
+	state->table = table;
+	for (int back = history; back >= 0; back--) {
+		state->keys[history - back] = game->keys[(game->ply - back) % GAME_HISTORY_SIZE];
 	}
+	state->rootIndex = history;
 
-	return 0;
+	int hasMove = runParallelSearch(state, &root, threads, result);
+	free(state);
+	return hasMove;
 }
 
 /*************************************************************************************************
-*	Function name: testBoardCheck
-*	Input: char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite
-*	Output: int (0 or 1)
-*	Function Operation: this function recieves current board, Move need to be checked, flag for color
-*	of turn, and flag for color to the threatened side. this function creat copy of the original board.
-*	Then the function perform the required move that give on the copied board. And then, there is using
-*	isCheckCase() function in order to check if the required move leads to check situation.
-*	If there is check case on the copied board - return 1
-*	If there is no check case on the copied board - return 0
+*	Function name: printSearchResult
+*	Input: SearchResult* result, FILE* report
+*	Output: None
+*	Function Operation: the function prints to report the depth, the score (in centipawns, or
+*	mate in moves), the nodes, the nodes per second and the principal variation of search result.
 ***************************************************************************************************/
-int testBoardCheck(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite) {
+void printSearchResult(SearchResult* result, FILE* report) {
 
-	char copiedBoard[SIZE][SIZE];
-	char promotionPieceChar;
-	char srcPieceChar;
+	char text[6];
 
-	// Copy the current board to new copied board
-	for (int i = 0; i < SIZE; i++) {
-		for (int j = 0; j < SIZE; j++) {
-			copiedBoard[i][j] = board[i][j];
-		}
+	fprintf(report, "depth %d score ", result->depth);
+	if (result->score >= MATE_SCORE - SEARCH_MAX_PLY) {
+		fprintf(report, "mate %d", (MATE_SCORE - result->score + 1) / 2);
+	}
+	else if (result->score <= -MATE_SCORE + SEARCH_MAX_PLY) {
+		fprintf(report, "mate %d", -((MATE_SCORE + result->score) / 2));
+	}
+	else {
+		fprintf(report, "cp %d", result->score);
 	}
+	fprintf(report, " nodes %llu nps %.0f pv", result->nodes, result->seconds > 0 ? result->nodes / result->seconds : 0.0);
+	for (int ply = 0; ply < result->pvLength; ply++) {
+		moveToCoordinates(result->pv[ply], text);
+		fprintf(report, " %s", text);
+	}
+	fprintf(report, "\n");
+}
 
-	// In case of white turn - define capital case the soruce piece char
-	if (move.isWhite) {
-		srcPieceChar = move.srcPiece;
+/*************************************************************************************************
+*	Function name: benchmarkParallelSearch
+*	Input: const char fen[], int depth, int maxThreads, size_t tableBytes
+*	Output: int (0 or 1)
+*	Function Operation: the function searches the position of fen to depth with 1, 2, 4 and so on
+*	threads until maxThreads (the number of processors if it is not positive), with search table
+*	of tableBytes which is cleared in any run. for any number of threads, it prints the time to
+*	depth, the nodes per second of all the threads and per thread, and the speedup of the time and
+*	of the nodes per second relative to single thread. 0 return if the fen is invalid or the table
+*	can't be allocated, otherwise 1.
+***************************************************************************************************/
+int benchmarkParallelSearch(const char fen[], int depth, int maxThreads, size_t tableBytes) {
 
-		//If there is promotion - define capital case for promotion piece char
-		if (move.isPromotion) {
-			promotionPieceChar = move.promotionPiece;
-		}
+	Position position;
+	SearchTable table;
+	SearchLimits limits = { depth, 0, 0 };
+	SearchResult result;
+	double singleSeconds = 0;
+	double singleRate = 0;
 
+	if (maxThreads <= 0) {
+		maxThreads = processorsCount();
+	}
+	if (createPosition(&position, fen) != FEN_OK || !initSearchTable(&table, tableBytes)) {
+		return 0;
 	}
-	// In case of black turn - define lower case the soruce piece char
-	else if (!move.isWhite) {
-		srcPieceChar = tolower(move.srcPiece);
 
-		//If there is promotion - define lower case for promotion piece char
-		if (move.isPromotion) {
-			promotionPieceChar = tolower(move.promotionPiece);
+	for (int threads = 1;; threads *= 2) {
+		if (threads > maxThreads) {
+			threads = maxThreads;
+		}
+		clearSearchTable(&table);
+		searchPosition(&position, &limits, &table, threads, &result);
 
+		double rate = result.seconds > 0 ? result.nodes / result.seconds : 0.0;
+		if (threads == 1) {
+			singleSeconds = result.seconds;
+			singleRate = rate;
+		}
+		printf("threads %d: %.3f s, %llu nodes, %.0f nodes/second (%.0f per thread), speedup %.2f, nodes/second x%.2f, ",
+			threads, result.seconds, result.nodes, rate, rate / threads, result.seconds > 0 ? singleSeconds / result.seconds : 0.0,
+			singleRate > 0 ? rate / singleRate : 0.0);
+		printSearchResult(&result, stdout);
+		if (threads == maxThreads) {
+			break;
 		}
 	}
+	freeSearchTable(&table);
+	return 1;
+}
 
 
-	//In case of Promotion, change the destination to hold the promotion piece char
-	if (move.isPromotion) {
-		copiedBoard[move.iDest][move.jDest] = promotionPieceChar;
-	}
+//neural evaluation
 
-	//In case with no Promotion, change the destination to hold the source piece char
-	else {
-		copiedBoard[move.iDest][move.jDest] = srcPieceChar;
+
+/*************************************************************************************************
+*	Function name: littleEndianInt
+*	Input: const unsigned char bytes[]
+*	Output: int
+*	Function Operation: the function returns the 32 bits integer which is stored in 4 bytes in
+*	little endian order, as in the network file, on CPU of any order.
+***************************************************************************************************/
+int littleEndianInt(const unsigned char bytes[]) {
+	return (int)((unsigned int)bytes[0] | (unsigned int)bytes[1] << 8 | (unsigned int)bytes[2] << 16
+		| (unsigned int)bytes[3] << 24);
+}
+
+/*************************************************************************************************
+*	Function name: loadNnueNetwork
+*	Input: const char path[]
+*	Output: int (0 or 1)
+*	Function Operation: the function loads the network of neural evaluation from the file of path.
+*	the file starts with NNUE_MAGIC and the number of features and of hidden values (32 bits), and
+*	then the 16 bits feature weights (row of any feature), the hidden biases and the output
+*	weights, and the 32 bits output bias, all in little endian order. the file must fit
+*	NNUE_FEATURES and NNUE_HIDDEN exactly. 1 return if the network was loaded (and it replaces the
+*	previous network), otherwise 0 and the previous network is kept. positions which were created
+*	before the network was loaded must be refreshed by refreshNnueAccumulator(), and the network
+*	must not be loaded while search is running.
+***************************************************************************************************/
+int loadNnueNetwork(const char path[]) {
+
+	unsigned char header[12];
+	unsigned char bias[4];
+	size_t weightsCount = (size_t)NNUE_FEATURES * NNUE_HIDDEN;
+	size_t valuesCount = weightsCount + NNUE_HIDDEN + COLORS * NNUE_HIDDEN;
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return 0;
+	}
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, NNUE_MAGIC, 4) != 0
+		|| littleEndianInt(header + 4) != NNUE_FEATURES || littleEndianInt(header + 8) != NNUE_HIDDEN) {
+		fclose(file);
+		return 0;
 	}
 
-	// Change the source location to be empty
-	copiedBoard[move.iSrc][move.jSrc] = EMPTY;
+	void* memory = malloc(valuesCount * sizeof(short) + CACHE_LINE_SIZE);
+	if (memory == NULL) {
+		fclose(file);
+		return 0;
+	}
+	short* values = (short*)((char*)memory + CACHE_LINE_SIZE - (size_t)memory % CACHE_LINE_SIZE);
+	if (fread(values, sizeof(short), valuesCount, file) != valuesCount || fread(bias, 1, sizeof(bias), file) != sizeof(bias)
+		|| fgetc(file) != EOF) {
+		free(memory);
+		fclose(file);
+		return 0;
+	}
+	fclose(file);
 
-	/*
-		Send the copied board to isCheckCase() function in order
-		to check if after performing move there is check situation.
-	*/
-	if (isCheckCase(copiedBoard, isWhiteMove, isTheratToWhite)) {
-		return 1;
+	// The values are converted in place from little endian, which doesn't change them on x86
+	for (size_t z = 0; z < valuesCount; z++) {
+		unsigned char* bytes = (unsigned char*)&values[z];
+		values[z] = (short)(bytes[0] | bytes[1] << 8);
 	}
 
-	return 0;
+	freeNnueNetwork();
+	nnueNetwork.memory = memory;
+	nnueNetwork.featureWeights = values;
+	nnueNetwork.featureBiases = values + weightsCount;
+	nnueNetwork.outputWeights = values + weightsCount + NNUE_HIDDEN;
+	nnueNetwork.outputBias = littleEndianInt(bias);
+	return 1;
+}
 
+/*************************************************************************************************
+*	Function name: freeNnueNetwork
+*	Input: None
+*	Output: None
+*	Function Operation: the function frees the loaded network, so evaluatePosition() returns to the
+*	tapered evaluation. it must not be called while search is running.
+***************************************************************************************************/
+void freeNnueNetwork() {
+	free(nnueNetwork.memory);
+	nnueNetwork.memory = NULL;
+	nnueNetwork.featureWeights = NULL;
+	nnueNetwork.featureBiases = NULL;
+	nnueNetwork.outputWeights = NULL;
+	nnueNetwork.outputBias = 0;
 }
 
 /*************************************************************************************************
-*	Function name: checkTrialWithoutDeclare
-*	Input: char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite
-*	Output: int (0 or 1)
-*	Function Operation: this function check if there is check trial without declaration.
-*	There is using in function testBoardCheck() which perfrom the move, and check if there is check
-*	case in the new board position.
-*	If there is check trial without declaration - return 1
-*	If there is no check trial or there is declaration - return 0
+*	Function name: nnueFeature
+*	Input: int perspective, int pieceCode, int square
+*	Output: int (feature index)
+*	Function Operation: the function returns the feature of piece code on square from the view of
+*	perspective color. black sees the board mirrored by the rows and the colors swapped, so both
+*	colors share the same weights for their own pieces.
 ***************************************************************************************************/
-int checkTrialWithoutDeclare(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite) {
+int nnueFeature(int perspective, int pieceCode, int square) {
+	if (perspective == BLACK_COLOR) {
+		pieceCode = (pieceCode + PIECE_TYPES) % NO_PIECE;
+		square = (SIZE - 1 - square / SIZE) * SIZE + square % SIZE;
+	}
+	return pieceCode * SQUARES + square;
+}
 
-	int isCheckAfterMove = testBoardCheck(board, move, isWhiteMove, isTheratToWhite);
-	if (!move.isCheck && !move.isMate && isCheckAfterMove) {
-		return 1;
+#if SIMD_SUPPORT
+/*************************************************************************************************
+*	Function name: accumulateFeatureAvx2
+*	Input: short accumulator[], const short weights[], int isAdded
+*	Output: None
+*	Function Operation: the function adds the weights row of feature to the hidden layer (or
+*	subtracts it, if isAdded is 0), 16 values at a time by AVX2. it is called only after the CPU
+*	support is checked.
+***************************************************************************************************/
+__attribute__((target("avx2"))) void accumulateFeatureAvx2(short accumulator[], const short weights[], int isAdded) {
+
+	for (int z = 0; z < NNUE_HIDDEN; z += 16) {
+		__m256i values = _mm256_loadu_si256((const __m256i*)(accumulator + z));
+		__m256i row = _mm256_loadu_si256((const __m256i*)(weights + z));
+		values = isAdded ? _mm256_add_epi16(values, row) : _mm256_sub_epi16(values, row);
+		_mm256_storeu_si256((__m256i*)(accumulator + z), values);
 	}
-	return 0;
 }
 
 /*************************************************************************************************
-*	Function name: checkDeclareWithoutTrial
-*	Input: char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite
-*	Output: int (0 or 1)
-*	Function Operation:  this function check if there is check declarattion without trial.
-*	There is using in function testBoardCheck() which perfrom the move, and check if there is check
-*	case in the new board position.
-*	If there is check declaration without trial - return 1
-*	If there is no check declaration or there is check trial - return 0
+*	Function name: accumulateFeatureSse2
+*	Input: short accumulator[], const short weights[], int isAdded
+*	Output: None
+*	Function Operation: the function is the same as accumulateFeatureAvx2(), by SSE2 instructions
+*	on 8 values at a time.
 ***************************************************************************************************/
-int checkDeclareWithoutTrial(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite) {
+void accumulateFeatureSse2(short accumulator[], const short weights[], int isAdded) {
 
-	int isCheckAfterMove = testBoardCheck(board, move, isWhiteMove, isTheratToWhite);
-	if ((move.isCheck || move.isMate) && !isCheckAfterMove) {
-		return 1;
+	for (int z = 0; z < NNUE_HIDDEN; z += 8) {
+		__m128i values = _mm_loadu_si128((const __m128i*)(accumulator + z));
+		__m128i row = _mm_loadu_si128((const __m128i*)(weights + z));
+		values = isAdded ? _mm_add_epi16(values, row) : _mm_sub_epi16(values, row);
+		_mm_storeu_si128((__m128i*)(accumulator + z), values);
 	}
-	return 0;
 }
 
 /*************************************************************************************************
-*	Function name: moveCauseToCheckThreat
-*	Input: char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite
-*	Output: int (0 or 1)
-*	Function Operation: this function check if the move cause to check threat to the player side color.
-*	According to chess rules, player can't make move that leads to a capture threat on his king.
-*	There is using in function testBoardCheck() which perfrom the move, and check if there is check
-*	case in the new board position.
-*	If the move leads to check case on the player which its his trun - return 1
-*	Id the move does not lead to check case - return 0
+*	Function name: nnueOutputAvx2
+*	Input: const short ownHidden[], const short otherHidden[], const short weights[]
+*	Output: int
+*	Function Operation: the function clips the hidden values of the side to move and of the other
+*	side to [0, NNUE_CLIP], and returns their dot product with the output weights. 16 values are
+*	clipped at a time by AVX2, and pairs of products are summed to 32 bits by madd. it is called
+*	only after the CPU support is checked.
 ***************************************************************************************************/
-int moveCauseToCheckThreat(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite) {
+__attribute__((target("avx2"))) int nnueOutputAvx2(const short ownHidden[], const short otherHidden[], const short weights[]) {
 
+	__m256i zero = _mm256_setzero_si256();
+	__m256i clip = _mm256_set1_epi16(NNUE_CLIP);
+	__m256i sum = _mm256_setzero_si256();
 
-	int isCheckAfterMove = testBoardCheck(board, move, isWhiteMove, isTheratToWhite);
-	if (isCheckAfterMove)
-	{
-		return 1;
+	for (int z = 0; z < NNUE_HIDDEN; z += 16) {
+		__m256i own = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(ownHidden + z)), zero), clip);
+		__m256i other = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(otherHidden + z)), zero), clip);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(own, _mm256_loadu_si256((const __m256i*)(weights + z))));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(other, _mm256_loadu_si256((const __m256i*)(weights + NNUE_HIDDEN + z))));
 	}
-	return 0;
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+	return _mm_cvtsi128_si32(half);
 }
 
 /*************************************************************************************************
-*	Function name: limitedMoveInCheckCase
-*	Input: char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite
-*	Output: int (0 or 1)
-*	Function Operation: this function check at first the current borad before perfroming the requested
-*	move. If there is check situation on the color turn, it means that there are specific moves which
-*	can be made in order to prevent king capture.
-*	- Moving the king.
-*	- Blocking the offensive line of the threatening piece.
-*	- capturing of the threatening piece
-*	Any other move is ilegal.
-*	At first, there is using isCheckCase() function to check the current board.
-*	If the board is already in check case, there is using in testBoardCheck() function which check
-*	after performing the move, if the board is in check case.
-*	If after the move, stiil there is check situation - it means that the move didnt prevent the
-*	check threat and the move and return 1.
-*	If there was no check situation on the original board, or the move prevented check
-*	situation - return 0.
-***************************************************************************************************/
-int limitedMoveInCheckCase(char board[][SIZE], Move move, int isWhiteMove, int isTheratToWhite) {
-
-	int isCheckAlready = isCheckCase(board, isWhiteMove, isTheratToWhite);
-	if (isCheckAlready) {
-		int isStillCheck = testBoardCheck(board, move, isWhiteMove, isTheratToWhite);
-		if (isStillCheck) {
-			return 1;
-		}
-		else {
-			return 0;
-		}
+*	Function name: nnueOutputSse2
+*	Input: const short ownHidden[], const short otherHidden[], const short weights[]
+*	Output: int
+*	Function Operation: the function is the same as nnueOutputAvx2(), by SSE2 instructions on 8
+*	values at a time.
+***************************************************************************************************/
+int nnueOutputSse2(const short ownHidden[], const short otherHidden[], const short weights[]) {
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i clip = _mm_set1_epi16(NNUE_CLIP);
+	__m128i sum = _mm_setzero_si128();
+
+	for (int z = 0; z < NNUE_HIDDEN; z += 8) {
+		__m128i own = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i*)(ownHidden + z)), zero), clip);
+		__m128i other = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i*)(otherHidden + z)), zero), clip);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(own, _mm_loadu_si128((const __m128i*)(weights + z))));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(other, _mm_loadu_si128((const __m128i*)(weights + NNUE_HIDDEN + z))));
 	}
 
-	return 0;
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum);
 }
+#endif
 
+/*************************************************************************************************
+*	Function name: accumulateFeature
+*	Input: short accumulator[], const short weights[], int isAdded
+*	Output: None
+*	Function Operation: the function adds the weights row of feature to the hidden layer, or
+*	subtracts it if isAdded is 0. it is done by AVX2 or SSE2 where they are available, otherwise
+*	value by value.
+***************************************************************************************************/
+void accumulateFeature(short accumulator[], const short weights[], int isAdded) {
 
-// make move and perfrom change on board
+#if SIMD_SUPPORT
+	if (__builtin_cpu_supports("avx2")) {
+		accumulateFeatureAvx2(accumulator, weights, isAdded);
+		return;
+	}
+	accumulateFeatureSse2(accumulator, weights, isAdded);
+#else
+	for (int z = 0; z < NNUE_HIDDEN; z++) {
+		accumulator[z] = (short)(isAdded ? accumulator[z] + weights[z] : accumulator[z] - weights[z]);
+	}
+#endif
+}
 
 /*************************************************************************************************
-*	Function name: performMove
-*	Input: char board[][SIZE], Move move
+*	Function name: addNnuePiece
+*	Input: Position* position, int pieceCode, int square, int isAdded
 *	Output: None
-*	Function Operation: this function recieves current board and Move that need to be performed
-*	on the board. This function check which piece need to be located in the destination and remove
-*	the piece from his source.
+*	Function Operation: the function updates the hidden layers of position from the view of both
+*	colors by the feature of piece code on square, which is added to the board (or removed from
+*	it, if isAdded is 0). it is called by placePiece() and removePiece() while network is loaded,
+*	so any move updates only the rows of the pieces which it moves.
 ***************************************************************************************************/
-void performMove(char board[][SIZE], Move move) {
-
-	char promotionPieceChar;
-	char srcPieceChar;
+void addNnuePiece(Position* position, int pieceCode, int square, int isAdded) {
+	for (int perspective = WHITE_COLOR; perspective < COLORS; perspective++) {
+		const short* weights = nnueNetwork.featureWeights + (size_t)nnueFeature(perspective, pieceCode, square) * NNUE_HIDDEN;
+		accumulateFeature(position->accumulator[perspective], weights, isAdded);
+	}
+}
 
-	// In case of white turn - define capital case the soruce piece char
-	if (move.isWhite) {
-		srcPieceChar = move.srcPiece;
+/*************************************************************************************************
+*	Function name: refreshNnueAccumulator
+*	Input: Position* position
+*	Output: None
+*	Function Operation: the function computes the hidden layers of position from scratch - the
+*	biases and the features of all the pieces on board. it is needed only for position which was
+*	created before the network was loaded. if no network is loaded, nothing is changed.
+***************************************************************************************************/
+void refreshNnueAccumulator(Position* position) {
 
-		//If there is promotion - define capital case for promotion piece char
-		if (move.isPromotion) {
-			promotionPieceChar = move.promotionPiece;
-		}
+	if (nnueNetwork.memory == NULL) {
+		return;
+	}
 
+	memcpy(position->accumulator[WHITE_COLOR], nnueNetwork.featureBiases, sizeof(short) * NNUE_HIDDEN);
+	memcpy(position->accumulator[BLACK_COLOR], nnueNetwork.featureBiases, sizeof(short) * NNUE_HIDDEN);
+	for (Bitboard pieces = position->allPieces; pieces;) {
+		int square = popLowestSquare(&pieces);
+		addNnuePiece(position, position->mailbox[square], square, 1);
 	}
-	// In case of black turn - define lower case the soruce piece char
-	else if (!move.isWhite) {
-		srcPieceChar = tolower(move.srcPiece);
-		//If there is promotion - define lower case for promotion piece char
-		if (move.isPromotion) {
-			promotionPieceChar = tolower(move.promotionPiece);
+}
 
-		}
+/*************************************************************************************************
+*	Function name: nnueOutput
+*	Input: const short ownHidden[], const short otherHidden[], const short weights[]
+*	Output: int
+*	Function Operation: the function returns the dot product of the clipped hidden values of the
+*	side to move and of the other side with the output weights (NNUE_HIDDEN weights for any side).
+*	it is computed by AVX2 or SSE2 where they are available, otherwise value by value.
+***************************************************************************************************/
+int nnueOutput(const short ownHidden[], const short otherHidden[], const short weights[]) {
+
+#if SIMD_SUPPORT
+	if (__builtin_cpu_supports("avx2")) {
+		return nnueOutputAvx2(ownHidden, otherHidden, weights);
+	}
+	return nnueOutputSse2(ownHidden, otherHidden, weights);
+#else
+	int sum = 0;
+	for (int z = 0; z < NNUE_HIDDEN; z++) {
+		int own = ownHidden[z] < 0 ? 0 : ownHidden[z] > NNUE_CLIP ? NNUE_CLIP : ownHidden[z];
+		int other = otherHidden[z] < 0 ? 0 : otherHidden[z] > NNUE_CLIP ? NNUE_CLIP : otherHidden[z];
+		sum += own * weights[z] + other * weights[NNUE_HIDDEN + z];
 	}
+	return sum;
+#endif
+}
+
+/*************************************************************************************************
+*	Function name: evaluateNnue
+*	Input: Position* position
+*	Output: int (score in centipawns)
+*	Function Operation: the function returns the score of position for the side to move by the
+*	loaded network. the hidden layers are kept in position, so only the output layer is computed,
+*	and the score is limited below the mate scores of search.
+***************************************************************************************************/
+int evaluateNnue(Position* position) {
 
-	//In case of Promotion, change the destination to hold the promotion piece char
-	if (move.isPromotion) {
-		board[move.iDest][move.jDest] = promotionPieceChar;
+	int color = position->isWhiteTurn ? WHITE_COLOR : BLACK_COLOR;
+	long long output = (long long)nnueOutput(position->accumulator[color], position->accumulator[!color],
+		nnueNetwork.outputWeights) + nnueNetwork.outputBias;
+	long long score = output * NNUE_OUTPUT_SCALE / (NNUE_CLIP * NNUE_WEIGHT_SCALE);
+
+	if (score > MATE_SCORE - SEARCH_MAX_PLY - 1) {
+		return MATE_SCORE - SEARCH_MAX_PLY - 1;
 	}
-	//In case with no Promotion, change the destination to hold the source piece char
-	else {
-		board[move.iDest][move.jDest] = srcPieceChar;
+	if (score < -(MATE_SCORE - SEARCH_MAX_PLY - 1)) {
+		return -(MATE_SCORE - SEARCH_MAX_PLY - 1);
 	}
-	// Change the source location to be empty
-	board[move.iSrc][move.jSrc] = EMPTY;
+	return (int)score;
 }
 
 /*************************************************************************************************
-*	Function name: makeMove
-*	Input: char board[][SIZE], char pgn[], int isWhiteTurn
+*	Function name: benchmarkNnueEvaluation
+*	Input: const char fen[], int iterations
 *	Output: int (0 or 1)
-*	Function Operation: this function recieves board as 2D array, String of PGN and color turn.
-	(1) At first, there is initialize of Move by using initMove() function which parse the infromation
-		from PGN and look for optional move on board.
-	(2) Then, there is testing of check conidtions on the current board after perfroming the initialized
-		Move which back from initMove() function. the tests are done by testCheckConditions().
-	(3) If the move which back from initMove() and from testCheckConditions() is legal, perform move
-		on the board by using performMove() function and return 1. If the move is ilegal return 0.
+*	Function Operation: the function measures the neural evaluation of the position of fen with
+*	the loaded network, any part iterations times: the evaluation by the kept hidden layers (from
+*	the view of both sides by turns, so it is computed in any iteration), the refresh of the hidden
+*	layers from scratch and the legal moves of position which are made and reverted (with
+*	incremental update of the hidden layers). it prints the rate of any part and the instructions
+*	which are used. 0 return if no network is loaded or the fen is invalid, otherwise 1.
 ***************************************************************************************************/
-int makeMove(char board[][SIZE], char pgn[], int isWhiteTurn) {
+int benchmarkNnueEvaluation(const char fen[], int iterations) {
 
-	Move move = initMove(board, pgn, isWhiteTurn);
+	Position position;
+	MoveList list;
+	UndoInfo undo;
+	long long checksum = 0;
+	volatile int sink = 0;
+	double startTime;
 
-	if (move.isLegal) {
-		move = testCheckConditions(board, move);
+	if (nnueNetwork.memory == NULL || createPosition(&position, fen) != FEN_OK) {
+		return 0;
+	}
+	generateLegalMoves(&position, &list);
+	int isWhiteTurn = position.isWhiteTurn;
+
+#if SIMD_SUPPORT
+	printf("NNUE kernels: %s\n", __builtin_cpu_supports("avx2") ? "AVX2" : "SSE2");
+#else
+	printf("NNUE kernels: scalar\n");
+#endif
+
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		position.isWhiteTurn = z & 1;
+		sink = evaluateNnue(&position);
+		checksum += sink;
 	}
+	printf("evaluateNnue: %.0f evaluations/second\n", iterations / (currentSeconds() - startTime));
+	position.isWhiteTurn = isWhiteTurn;
 
-	if (move.isLegal) {
-		performMove(board, move);
-		return 1;
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations; z++) {
+		refreshNnueAccumulator(&position);
+		checksum += position.accumulator[WHITE_COLOR][z % NNUE_HIDDEN];
 	}
-	return 0;
+	printf("refreshNnueAccumulator: %.0f refreshes/second\n", iterations / (currentSeconds() - startTime));
+
+	long long moves = 0;
+	startTime = currentSeconds();
+	for (int z = 0; z < iterations && list.count > 0; z++) {
+		doMove(&position, list.moves[z % list.count], &undo);
+		checksum += position.accumulator[BLACK_COLOR][z % NNUE_HIDDEN];
+		undoMove(&position, &undo);
+		moves++;
+	}
+	printf("doMove + undoMove: %.0f moves/second\n", moves / (currentSeconds() - startTime));
+	printf("Checksum: %lld\n", checksum);
+	return 1;
 }
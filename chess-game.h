@@ -0,0 +1,800 @@
+#ifndef CHESS_GAME_H
+#define CHESS_GAME_H
+
+/*
+	Types, constants and functions of the chess game, which are shared by chess-game.c and by the
+	tools which are linked with it, so any use is checked against the definitions.
+*/
+
+// POSIX declarations (mmap, posix_madvise) are needed also in strict C11 builds on Unix systems
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "ass4.h"
+
+#if !defined(SIZE) || SIZE < 1
+#error "ass4.h must define the board SIZE"
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// PEXT instruction (BMI2) may be used for sliding attacks, the CPU support is checked at runtime
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(NO_PEXT)
+#define PEXT_SUPPORT 1
+#include <immintrin.h>
+#else
+#define PEXT_SUPPORT 0
+#endif
+
+// SSE2 and AVX2 instructions may be used for FEN conversions and for the neural evaluation kernels,
+// the AVX2 support is checked at runtime
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(NO_SIMD)
+#define SIMD_SUPPORT 1
+#include <immintrin.h>
+#else
+#define SIMD_SUPPORT 0
+#endif
+
+// POSIX systems give the number of online processors by sysconf(), and close() for mapped files
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// PGN files may be mapped to memory on POSIX systems, otherwise they are read in chunks
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(NO_MMAP)
+#define MMAP_SUPPORT 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define MMAP_SUPPORT 0
+#endif
+
+// Batch validation and parallel search run on C11 threads where they are available, otherwise in
+// the calling thread
+#if !defined(__STDC_NO_THREADS__) && !defined(NO_THREADS)
+#define THREADS_SUPPORT 1
+#include <threads.h>
+#include <stdatomic.h>
+#else
+#define THREADS_SUPPORT 0
+#endif
+
+// Structures which are accessed together in hot loops are aligned to cache line
+#define CACHE_LINE_SIZE 64
+#if defined(_MSC_VER)
+#define CACHE_ALIGNED __declspec(align(CACHE_LINE_SIZE))
+#else
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#endif
+
+
+/*
+	Annotation of PGN move: the piece chars, the board indexes (-1 if unknown) and the flags
+	which were declared. castling is the index of castling move in castlingMoves, or -1 for any
+	other move. isEnPassant is set when Pawn capture is found to be en passant, and isStalemate
+	when the trial of the move leaves the opponent without legal move and not in check. it is used
+	only while PGN move is validated, and it is passed by pointer.
+*/
+typedef struct {
+	char srcPiece, destPiece, promotionPiece;
+	signed char iSrc, jSrc, iDest, jDest, castling;
+	char isWhite, isCapture, isPromotion, isCheck, isMate, isLegal, isEnPassant, isStalemate;
+} Move;
+
+// Results of PGN move which is made on position: illegal, legal, or legal with stalemate after it
+enum { MOVE_ILLEGAL, MOVE_LEGAL, MOVE_STALEMATE };
+
+// Bitboard holds one bit for any square on board. Square index is (row * SIZE + column).
+typedef unsigned long long Bitboard;
+
+#if SIZE * SIZE > 64
+#error "Bitboard position requires board with no more than 64 squares"
+#endif
+
+#define SQUARES (SIZE * SIZE)
+#define COLORS 2
+#define PIECE_TYPES 6
+
+// Zobrist key of position, XOR of random keys of its pieces on their squares and of the turn
+typedef unsigned long long HashKey;
+
+// Colors indexes and pieces types indexes which are used in bitboard position
+enum { WHITE_COLOR, BLACK_COLOR };
+enum { PAWN_TYPE, KNIGHT_TYPE, BISHOP_TYPE, ROOK_TYPE, QUEEN_TYPE, KING_TYPE };
+
+// Piece code in mailbox is (color * PIECE_TYPES + type), NO_PIECE represents empty square
+#define NO_PIECE (COLORS * PIECE_TYPES)
+
+// Inputs of neural evaluation (any piece code on any square) and size of its hidden layer
+#define NNUE_FEATURES (NO_PIECE * SQUARES)
+#define NNUE_HIDDEN 128
+
+/*
+	Position holds the whole state of game which the rules depend on, so any function gets single
+	pointer instead of 2D array board and turn flag. the bitboards come first, then the mailbox and
+	the small fields, and the struct is aligned to cache line, so the bitboards which are read by
+	any attack computation share the first cache lines and position never straddles extra line.
+*/
+typedef struct CACHE_ALIGNED {
+	Bitboard pieces[COLORS][PIECE_TYPES];
+	Bitboard occupancy[COLORS];
+	Bitboard allPieces;
+
+	/*
+		Check state of the side to move, which is updated incrementally by performMove():
+		the opponent pieces which give check, the pieces of side to move which are pinned
+		to their king, and the king squares (-1 if there is no king).
+	*/
+	Bitboard checkers;
+	Bitboard pinned;
+
+	// Zobrist key, which is updated incrementally by placePiece(), removePiece() and doMove()
+	HashKey key;
+
+	/*
+		Terms of tapered evaluation for white, which are updated incrementally by placePiece() and
+		removePiece(): the material and piece-square score of middlegame and of endgame, and the
+		game phase by the pieces on board (TOTAL_PHASE in the initial position).
+	*/
+	int middlegameScore;
+	int endgameScore;
+	int phase;
+
+	unsigned char mailbox[SQUARES];
+	int kingSquare[COLORS];
+	int isWhiteTurn;
+
+	// Castling rights bits (CASTLE_*), which are removed by doMove() when King or Rook moves
+	int castlingRights;
+
+	/*
+		En passant target square after Pawn moved two steps, or -1. it is set only if Pawn of the
+		side to move attacks it, so positions which differ only by impossible en passant are equal.
+	*/
+	int enPassantSquare;
+
+	// Plies since the last Pawn move or capture, and number of the move which starts at 1
+	int halfmoveClock;
+	int fullmoveNumber;
+
+	/*
+		Hidden layer of neural evaluation from the view of any color, which is updated incrementally
+		by placePiece() and removePiece() while network is loaded. it is the last field, so the
+		fields above are still read in the first cache lines.
+	*/
+	CACHE_ALIGNED short accumulator[COLORS][NNUE_HIDDEN];
+} Position;
+
+/*
+	Move of the engine in 16 bits: bits 0-5 are the source square, bits 6-11 are the destination
+	square and bits 12-15 are flags. flag MOVE_PROMOTION marks promotion, and then the promotion
+	piece type is KNIGHT_TYPE plus the two low bits of flags. flag MOVE_CASTLING marks castling,
+	which is encoded as the King move, and the Rook move is derived from it. the other flags are
+	free for special moves. flag MOVE_EN_PASSANT marks en passant capture, whose captured Pawn is
+	not on the destination. NULL_MOVE (a1 to a1) is never legal move.
+*/
+typedef unsigned short EncodedMove;
+
+#define NULL_MOVE 0
+#define MOVE_CASTLING 1
+#define MOVE_EN_PASSANT 2
+#define MOVE_PROMOTION 8
+
+/*
+	Information which is saved by doMove() in order to revert the move by undoMove():
+	the move, the piece codes of the moved and captured pieces, the castling rights, the en passant
+	square, the halfmove clock and the check state before the move.
+*/
+typedef struct {
+	EncodedMove move;
+	unsigned char movedPiece, capturedPiece, castlingRights;
+	signed char enPassantSquare;
+	int halfmoveClock;
+	Bitboard checkers, pinned;
+} UndoInfo;
+
+/*
+	Move list which is filled by moves generation. the list has fixed capacity, which is more than
+	the maximum number of moves in any chess position.
+*/
+#define MAX_MOVES 256
+
+typedef struct {
+	EncodedMove moves[MAX_MOVES];
+	int count;
+} MoveList;
+
+// Castling rights bits, in the order of FEN castling chars
+#define CASTLE_WHITE_KING 1
+#define CASTLE_WHITE_QUEEN 2
+#define CASTLE_BLACK_KING 4
+#define CASTLE_BLACK_QUEEN 8
+#define CASTLING_MOVES 4
+
+/*
+	Castling move of single right: the King and Rook squares before and after the move, the squares
+	which must be empty and the squares which the King passes and arrives to, which must not be
+	attacked. the King starts in the middle column and the Rooks in the corners of the first line,
+	and as in the standard board the King arrives to the second column from the Rook corner.
+*/
+typedef struct {
+	int kingSrc, kingDest, rookSrc, rookDest;
+	Bitboard emptySquares;
+	Bitboard kingPath;
+} CastlingMove;
+
+// Maximum length of FEN which is written by positionToFen(), with the NUL
+#define FEN_MAX_LENGTH (SQUARES + SIZE + 32)
+
+// Errors of FEN parsing, which are returned by parseFen()
+enum {
+	FEN_OK, FEN_BAD_PIECE, FEN_BAD_ROW, FEN_BAD_ROWS_COUNT, FEN_BAD_SIDE, FEN_BAD_CASTLING,
+	FEN_BAD_EN_PASSANT, FEN_BAD_CLOCK, FEN_EXTRA_DATA
+};
+
+// Errors of SAN parsing, which are returned by parseSan()
+enum {
+	SAN_OK, SAN_EMPTY, SAN_BAD_PIECE, SAN_BAD_SQUARE, SAN_BAD_CAPTURE, SAN_BAD_PROMOTION,
+	SAN_BAD_CASTLING, SAN_EXTRA_DATA
+};
+
+/*
+	Classes of chars in sanChars table, in the high bits of the entry. the low bits hold the index
+	on 2D array board of column or row char, and the piece type of piece char.
+*/
+enum {
+	SAN_OTHER = 0x00, SAN_COLUMN = 0x10, SAN_ROW = 0x20, SAN_PIECE = 0x30, SAN_CAPTURE = 0x40,
+	SAN_PROMOTION = 0x50, SAN_CHECK = 0x60, SAN_MATE = 0x70, SAN_CASTLING = 0x80
+};
+#define SAN_CLASS(entry) ((entry) & 0xF0)
+#define SAN_VALUE(entry) ((entry) & 0x0F)
+
+/*
+	All the six fields of FEN: piece code of any square (NO_PIECE for empty square), side to move,
+	castling rights bits, en passant target square (-1 if none), halfmove clock and fullmove number.
+*/
+typedef struct {
+	unsigned char mailbox[SQUARES];
+	int isWhiteTurn;
+	int castlingRights;
+	int enPassantSquare;
+	int halfmoveClock;
+	int fullmoveNumber;
+} FenFields;
+
+// Reference position for perft: FEN, depth and the expected number of nodes
+typedef struct {
+	const char* fen;
+	int depth;
+	unsigned long long nodes;
+} PerftReference;
+
+/*
+	Entries of transposition table, which are written and read by several threads without locks.
+	any entry holds its check, which is the XOR of its lookup key and of its data, so entry which
+	was torn by two threads writing together doesn't match any key and is treated as miss. legality
+	entry caches the result of PGN move text on position: the lookup key is the position key XOR
+	the hash of the text, and the data holds the encoded move, the legality and stalemate flags and
+	the high half of the position key, which must match too, so other position and text with the
+	same lookup key is miss. moves entry caches the legal moves of position (the first CACHED_MOVES
+	moves at most, so the entry fills two cache lines), and its check is the position key XOR the
+	checksum of the moves.
+*/
+#define LEGALITY_BUCKET_SIZE 4
+#define CACHED_MOVES 59
+#define CACHED_MOVE_LEGAL (1ULL << 16)
+#define CACHED_MOVE_STALEMATE (1ULL << 17)
+#define CACHED_POSITION_MASK 0xFFFFFFFF00000000ULL
+
+typedef struct {
+	HashKey check;
+	HashKey data;
+} LegalityEntry;
+
+typedef struct {
+	LegalityEntry entries[LEGALITY_BUCKET_SIZE];
+} LegalityBucket;
+
+typedef struct {
+	HashKey check;
+	unsigned short count;
+	EncodedMove moves[CACHED_MOVES];
+} MovesEntry;
+
+#if THREADS_SUPPORT
+typedef atomic_ulong TableCounter;
+#else
+typedef unsigned long TableCounter;
+#endif
+
+/*
+	Transposition table of validated positions, in fixed memory budget which is divided between
+	the legality buckets and the moves entries. the numbers of buckets and entries are powers of
+	two, so the index is the low bits of the key. memory is the allocation, which is aligned to
+	cache lines. the counters count the probes of both kinds.
+*/
+typedef struct {
+	LegalityBucket* buckets;
+	MovesEntry* movesEntries;
+	size_t bucketsMask;
+	size_t movesMask;
+	void* memory;
+	TableCounter hits;
+	TableCounter misses;
+} TranspositionTable;
+
+/*
+	State of game: the position (with the halfmove clock of fifty-move rule) and bounded history of
+	the keys of the last positions, in ring buffer which is indexed by ply. repetitions[ply] is the
+	number of times that the position of ply occurred until it, which is computed once when the
+	position is recorded. repetition can't cross irreversible move, so the history has to hold only
+	the positions since the last one. GAME_HISTORY_SIZE is power of two which is more than the 100
+	plies of fifty-move rule, so the repetitions are exact as long as draw can't be claimed by it.
+*/
+#define GAME_HISTORY_SIZE 128
+#define FIFTY_MOVES_PLIES 100
+
+typedef struct {
+	Position position;
+	HashKey keys[GAME_HISTORY_SIZE];
+	unsigned char repetitions[GAME_HISTORY_SIZE];
+	int ply;
+} GameState;
+
+/*
+	Scores of search in centipawns for the side to move. mate in ply n from root is scored
+	(MATE_SCORE - n), so shorter mate is better, and any score is inside INFINITE_SCORE.
+*/
+#define MATE_SCORE 30000
+#define INFINITE_SCORE 32000
+#define SEARCH_MAX_PLY 64
+
+// First window around the score of the previous iteration, and nodes between checks of time budget
+#define ASPIRATION_WINDOW 25
+#define SEARCH_CHECK_NODES 1024
+
+// Budget of search: maximum depth in plies, nodes and seconds (0 for no limit of nodes or time)
+typedef struct {
+	int maxDepth;
+	unsigned long long maxNodes;
+	double maxSeconds;
+} SearchLimits;
+
+/*
+	Result of search: the best move of the last completed iteration (0 if there is no legal move),
+	its score, the completed depth, the nodes and time of the whole search and the principal
+	variation, the expected line of moves which starts with the best move.
+*/
+typedef struct {
+	EncodedMove bestMove;
+	int score;
+	int depth;
+	unsigned long long nodes;
+	double seconds;
+	int pvLength;
+	EncodedMove pv[SEARCH_MAX_PLY];
+} SearchResult;
+
+/*
+	Entries of search table, which are shared by the threads of parallel search without locks, like
+	the entries of TranspositionTable: the check of entry is the position key XOR its data, so entry
+	which was torn by two threads writing together doesn't match any key. data holds the best move
+	(bits 0-15), the score (bits 16-31), the depth (bits 32-39), the bound of the score (bits 40-41)
+	and the generation of the search which stored it (bits 48-55). bucket fills one cache line.
+*/
+#define SEARCH_BUCKET_SIZE 4
+
+// Bound of score in search table: the real score is at most, at least or exactly the score
+enum { BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT };
+
+typedef struct {
+	HashKey check;
+	HashKey data;
+} SearchEntry;
+
+typedef struct {
+	SearchEntry entries[SEARCH_BUCKET_SIZE];
+} SearchBucket;
+
+/*
+	Search table in fixed memory budget, with power of two buckets which is indexed by the low bits
+	of the position key. memory is the allocation, which is aligned to cache lines. generation is
+	advanced by any search, so entries of the previous searches are replaced first.
+*/
+typedef struct {
+	SearchBucket* buckets;
+	size_t bucketsMask;
+	void* memory;
+	int generation;
+} SearchTable;
+
+#if THREADS_SUPPORT
+typedef atomic_int SearchFlag;
+typedef atomic_ullong SearchCounter;
+#else
+typedef int SearchFlag;
+typedef unsigned long long SearchCounter;
+#endif
+
+// State which is shared by the threads of one search: the stop flag and the total nodes
+typedef struct {
+	SearchFlag isStopped;
+	SearchCounter nodes;
+} SearchShared;
+
+/*
+	State of one search thread: the budget, the shared table and state (the table may be NULL), the
+	thread id (0 for the main thread), the counters and the stop flag, the keys of positions on the
+	path from root (after the keys of game history before root) for repetitions, the triangular
+	principal variation table, where pv[ply] is the line from ply, the line of the previous
+	iteration and two killer moves (quiet moves which caused cutoff) for any ply. reportedNodes are
+	the nodes which were added to the shared nodes, which were knownNodes then.
+*/
+typedef struct {
+	SearchLimits limits;
+	SearchTable* table;
+	SearchShared* shared;
+	int id;
+	double startTime;
+	unsigned long long nodes;
+	unsigned long long reportedNodes;
+	unsigned long long knownNodes;
+	int isStopped;
+	int rootIndex;
+	HashKey keys[GAME_HISTORY_SIZE + SEARCH_MAX_PLY + 1];
+	int pvLength[SEARCH_MAX_PLY + 1];
+	EncodedMove pv[SEARCH_MAX_PLY + 1][SEARCH_MAX_PLY + 1];
+	EncodedMove previousPv[SEARCH_MAX_PLY + 1];
+	int previousPvLength;
+	EncodedMove killers[SEARCH_MAX_PLY + 1][2];
+} SearchState;
+
+// Thread of parallel search, with its own copy of root position and its own result
+typedef struct {
+	SearchState state;
+	Position position;
+	SearchResult result;
+} SearchWorker;
+
+/*
+	Quantized network of neural evaluation, which is loaded by loadNnueNetwork(): the weights of any
+	feature (row of NNUE_HIDDEN values) and the biases of the hidden layer, and the output weights
+	of the hidden layer from the view of the side to move and of the other side. the arrays are in
+	memory which is aligned to cache line, or NULL if no network is loaded.
+*/
+typedef struct {
+	short* featureWeights;
+	short* featureBiases;
+	short* outputWeights;
+	int outputBias;
+	void* memory;
+} NnueNetwork;
+
+/*
+	Quantization of network: the hidden values are clipped to [0, NNUE_CLIP], the output weights are
+	scaled by NNUE_WEIGHT_SCALE, and the output is scaled to centipawns by NNUE_OUTPUT_SCALE.
+*/
+#define NNUE_CLIP 255
+#define NNUE_WEIGHT_SCALE 64
+#define NNUE_OUTPUT_SCALE 400
+
+// First bytes of network file, and the hidden layer is processed in whole AVX2 vectors
+#define NNUE_MAGIC "CGNN"
+#if NNUE_HIDDEN % 16
+#error "Neural evaluation requires hidden layer of multiple of 16 values"
+#endif
+
+// Size of PGN reader buffer, and sizes of FEN tag value and of illegal move text which are kept
+#define PGN_BUFFER_SIZE 65536
+#define PGN_FEN_SIZE 128
+#define PGN_MOVE_SIZE 32
+
+/*
+	PGN reader on memory data or on file. memory (or memory mapped file) is parsed in place.
+	file is read in chunks into the fixed buffer, and data points to the buffer. in both cases
+	the PGN is processed in constant memory and in single pass. tokenStart is the start of the
+	token which is read (if isInToken), which is kept when the buffer is refilled. line and games
+	count the lines and the games which were read. table is transposition table for the moves
+	validation, or NULL.
+*/
+typedef struct {
+	FILE* file;
+	const char* data;
+	size_t length;
+	size_t index;
+	size_t tokenStart;
+	int isInToken;
+	int isMapped;
+	long line;
+	long games;
+	TranspositionTable* table;
+	char buffer[PGN_BUFFER_SIZE];
+} PgnReader;
+
+// Token of PGN: view to the text in the reader data, which is not NUL terminated
+typedef struct {
+	const char* text;
+	int length;
+} PgnToken;
+
+// Types of PGN tokens which are returned by readPgnToken()
+enum { PGN_END, PGN_TAG, PGN_MOVE, PGN_RESULT };
+
+/*
+	Verdict of PGN game: the number of legal plies which were made and the result. in case of
+	illegal move, its ply number (1 for the first move), line and text, otherwise illegalPly is 0.
+	isStalemate is 1 if the last legal move left the opponent in stalemate, so the game is drawn
+	whatever its result tag says. drawPly is the first ply after which draw could be claimed by
+	threefold repetition or by fifty-move rule, otherwise 0.
+*/
+typedef struct {
+	long gameNumber;
+	int plies;
+	int isStalemate;
+	int drawPly;
+	int illegalPly;
+	long illegalLine;
+	char illegalMove[PGN_MOVE_SIZE];
+	char result[8];
+} PgnGameVerdict;
+
+// Game of batch validation: PGN text of single game (tags and moves), not NUL terminated
+typedef struct {
+	const char* text;
+	size_t length;
+} PgnGameInput;
+
+#if THREADS_SUPPORT
+/*
+	Deque of worker in batch validation. the games of worker are the indexes in [head, tail):
+	the worker takes games from the tail, and other workers steal games from the head.
+*/
+typedef struct {
+	mtx_t lock;
+	int head;
+	int tail;
+} BatchDeque;
+
+// Shared state of batch validation workers, and the index of any worker
+typedef struct {
+	const PgnGameInput* games;
+	PgnGameVerdict* verdicts;
+	BatchDeque* deques;
+	TranspositionTable* table;
+	int workers;
+} BatchPool;
+
+typedef struct {
+	BatchPool* pool;
+	int id;
+} BatchWorker;
+#endif
+
+/*
+	Sliding attacks entry of square. the attacks of Rook or Bishop on square are stored in table,
+	which is indexed by the relevant occupied squares (mask) - by magic multiplication or by PEXT.
+*/
+typedef struct {
+	Bitboard mask;
+	Bitboard magic;
+	Bitboard* attacks;
+	int shift;
+} SlidingEntry;
+
+// Maximum number of relevant occupancy bits and total sizes of sliding attacks tables (for 8x8 board)
+#define MAX_SLIDING_BITS 12
+#define ROOK_TABLE_SIZE 102400
+#define BISHOP_TABLE_SIZE 5248
+
+// Functions Declarations
+void printColumns();
+void printSpacers();
+void printRow(char row[], int rowIdx);
+Bitboard squareBit(int square);
+int squareIndex(int i, int j);
+int lowestSquare(Bitboard bitboard);
+int popLowestSquare(Bitboard* bitboard);
+int countSquares(Bitboard bitboard);
+EncodedMove encodeMove(int src, int dest, int promotionType);
+int moveSrc(EncodedMove move);
+int moveDest(EncodedMove move);
+int movePromotionType(EncodedMove move);
+int pieceTypeFromChar(char piece);
+char pieceCharFromCode(int pieceCode);
+void clearPosition(Position* position);
+void placePiece(Position* position, int color, int type, int square);
+void removePiece(Position* position, int square);
+int parseFenNumber(const char fen[], int length, int* c, int* number);
+int parseFen(const char fen[], int length, FenFields* fields);
+int parseFenBulk(const char text[], size_t length, FenFields fields[], int errors[], int maxCount);
+const char* fenErrorText(int error);
+int createPosition(Position* position, const char fen[]);
+#if SIMD_SUPPORT
+Bitboard emptySquaresMaskAvx2(const char squares[]);
+Bitboard emptySquaresMaskSse2(const char squares[]);
+void fillEmptySquaresAvx2(char squares[]);
+void fillEmptySquaresSse2(char squares[]);
+#endif
+Bitboard emptySquaresMask(const char squares[]);
+void fillEmptySquares(char squares[]);
+int writeFenPlacement(const char squares[], Bitboard empty, char fen[]);
+int boardToFen(char board[][SIZE], char fen[]);
+int positionToFen(Position* position, char fen[]);
+int fenToBoard(const char fen[], int length, char board[][SIZE]);
+void benchmarkFenConversion(const char fen[], int iterations);
+int initTranspositionTable(TranspositionTable* table, size_t bytes);
+void clearTranspositionTable(TranspositionTable* table);
+void freeTranspositionTable(TranspositionTable* table);
+void countTableProbe(TranspositionTable* table, int isHit);
+HashKey moveTextHash(const char pgn[], int length);
+int probeMoveLegality(TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove* move);
+void storeMoveLegality(TranspositionTable* table, HashKey positionKey, HashKey textHash, EncodedMove move, int result);
+HashKey movesChecksum(const EncodedMove moves[], int count);
+int cachedLegalMoves(TranspositionTable* table, Position* position, MoveList* list);
+int isCachedMoveLegal(TranspositionTable* table, Position* position, EncodedMove move);
+int makeCachedMove(TranspositionTable* table, Position* position, const char pgn[], int length);
+void printTableCounters(TranspositionTable* table, FILE* report);
+void recordGamePosition(GameState* game);
+int createGameState(GameState* game, const char fen[]);
+int playGameMove(GameState* game, TranspositionTable* table, const char pgn[], int length);
+int repetitionCount(GameState* game);
+int isThreefoldRepetition(GameState* game);
+int isFiftyMoveRule(GameState* game);
+int canClaimDraw(GameState* game);
+int evaluatePosition(Position* position);
+int isCaptureMove(Position* position, EncodedMove move);
+void scoreSearchMoves(SearchState* state, Position* position, MoveList* list, int ply, EncodedMove tableMove,
+	int scores[]);
+EncodedMove pickSearchMove(MoveList* list, int scores[], int index);
+unsigned long long addSearchNodes(SearchShared* shared, unsigned long long nodes);
+int isSharedSearchStopped(SearchShared* shared);
+void stopSharedSearch(SearchShared* shared);
+int isSearchStopped(SearchState* state);
+int isSearchDraw(SearchState* state, Position* position, int ply);
+int quiescenceSearch(SearchState* state, Position* position, int ply, int alpha, int beta);
+int alphaBetaSearch(SearchState* state, Position* position, int depth, int ply, int alpha, int beta);
+int iterativeDeepening(SearchState* state, Position* position, SearchResult* result);
+int initSearchTable(SearchTable* table, size_t bytes);
+void clearSearchTable(SearchTable* table);
+void freeSearchTable(SearchTable* table);
+int scoreToTable(int score, int ply);
+int scoreFromTable(int score, int ply);
+int probeSearchTable(SearchTable* table, HashKey key, EncodedMove* move, int* score, int* depth, int* bound);
+void storeSearchTable(SearchTable* table, HashKey key, EncodedMove move, int score, int depth, int bound);
+#if THREADS_SUPPORT
+int runSearchWorker(void* argument);
+#endif
+int runParallelSearch(SearchState* state, Position* position, int threads, SearchResult* result);
+int searchPosition(Position* position, const SearchLimits* limits, SearchTable* table, int threads, SearchResult* result);
+int searchGame(GameState* game, const SearchLimits* limits, SearchTable* table, int threads, SearchResult* result);
+int benchmarkParallelSearch(const char fen[], int depth, int maxThreads, size_t tableBytes);
+void printSearchResult(SearchResult* result, FILE* report);
+int littleEndianInt(const unsigned char bytes[]);
+int loadNnueNetwork(const char path[]);
+void freeNnueNetwork();
+int nnueFeature(int perspective, int pieceCode, int square);
+void accumulateFeature(short accumulator[], const short weights[], int isAdded);
+void addNnuePiece(Position* position, int pieceCode, int square, int isAdded);
+void refreshNnueAccumulator(Position* position);
+int nnueOutput(const short ownHidden[], const short otherHidden[], const short weights[]);
+int evaluateNnue(Position* position);
+int benchmarkNnueEvaluation(const char fen[], int iterations);
+void loadPosition(Position* position, char board[][SIZE], int isWhiteTurn);
+void positionToBoard(Position* position, char board[][SIZE]);
+void printPosition(Position* position);
+Bitboard rayAttacks(int square, Bitboard occupied, const int directions[][2], int directionsCount);
+Bitboard knightAttacks(int square);
+Bitboard kingAttacks(int square);
+Bitboard pawnAttacks(int color, int square);
+Bitboard pawnPushes(int color, int square);
+Bitboard relevantOccupancy(int square, const int directions[][2]);
+Bitboard randomMagic(Bitboard* seed);
+int initSlidingEntry(SlidingEntry* entry, int square, const int directions[][2], Bitboard knownMagic, Bitboard* table, Bitboard* seed);
+void initSlidingTables();
+void initChessTables();
+void initChessGame();
+HashKey randomKey(HashKey* seed);
+void initZobristKeys();
+HashKey computePositionKey(Position* position);
+HashKey boardKey(char board[][SIZE], int isWhiteTurn);
+unsigned int slidingIndex(SlidingEntry* entry, Bitboard occupied);
+Bitboard bishopAttacks(int square, Bitboard occupied);
+Bitboard rookAttacks(int square, Bitboard occupied);
+Bitboard queenAttacks(int square, Bitboard occupied);
+void initLineSquares();
+void initCastlingMoves();
+int castlingIndex(EncodedMove move, int color);
+int placementCastlingRights(Position* position);
+void setCastlingRights(Position* position, int castlingRights);
+int isCastlingAvailable(Position* position, int index);
+int parseCastlingFromPgn(const char pgn[], int length, Move* move);
+int checkCastlingMove(Position* position, Move* move);
+void addCastlingMoves(Position* position, MoveList* list);
+int enPassantCapturedSquare(int src, int dest);
+int isEnPassantPossible(Position* position, int square);
+void setEnPassantSquare(Position* position, int square);
+int enPassantExposesKing(Position* position, int src, int dest);
+void addEnPassantMoves(Position* position, MoveList* list);
+Bitboard attackersTo(Position* position, int square, int color, Bitboard occupied);
+Bitboard pinnedPieces(Position* position, int color);
+void computeCheckState(Position* position);
+void updateCheckState(Position* position, int movedSquare);
+void initMove(Position* position, const char pgn[], int length, Move* move);
+void initSanChars();
+void initPieceSquareTables();
+int parseSan(const char pgn[], int length, Move* move);
+const char* sanErrorText(int error);
+void benchmarkSanParsing(const char* moves[], int count, int iterations);
+char findDestPiece(int iDest, int jDest, Position* position);
+EncodedMove encodeAnnotatedMove(Move* move);
+Bitboard optionalSourceSquares(Position* position, Move* move, int type);
+void findOptionalPieceByMove(Position* position, Move* move);
+int checkRookMove(Position* position, Move* move, int iOptSrc, int jOptSrc);
+int checkKnightMove(Move* move, int iOptSrc, int jOptSrc);
+int checkBishopMove(Position* position, Move* move, int iOptSrc, int jOptSrc);
+int checkQueenMove(Position* position, Move* move, int iOptSrc, int jOptSrc);
+int checkKingMove(Move* move, int iOptSrc, int jOptSrc);
+int checkPawnMove(Position* position, Move* move, int iOptSrc, int jOptSrc);
+int isWhiteDest(char destPiece);
+int sameColorPieceTest(char destPiece, int isWhite);
+int noCaptureDestTest(int isCapture, char destPiece);
+int noCaptureDeclareTest(char destPiece, int isWhite, int isCapture);
+void testCheckConditions(Position* position, Move* move);
+int isCheckCase(Position* position, int isWhiteMove, int isTheratToWhite);
+int checkTrialWithoutDeclare(Move* move, int isCheckAfterMove);
+int checkDeclareWithoutTrial(Move* move, int isCheckAfterMove);
+int mateTrialWithoutDeclare(Move* move, int isMateAfterMove);
+int mateDeclareWithoutTrial(Move* move, int isMateAfterMove);
+int moveExposesKing(Position* position, int src, int dest);
+int moveIgnoresCheck(Position* position, int src, int dest);
+int moveCauseToCheckThreat(Position* position, Move* move);
+int limitedMoveInCheckCase(Position* position, Move* move);
+void doMove(Position* position, EncodedMove move, UndoInfo* undo);
+void undoMove(Position* position, UndoInfo* undo);
+void performMove(Position* position, Move* move);
+int makePositionMove(Position* position, const char pgn[], int length);
+int makeUndoableMove(Position* position, const char pgn[], int length, UndoInfo* undo);
+char pieceAt(Position* position, int i, int j);
+int isInCheck(Position* position);
+void addMove(MoveList* list, int src, int dest, int promotionType);
+void addPawnMoves(MoveList* list, int src, Bitboard targets, int lastLine);
+int generatePseudoLegalMoves(Position* position, MoveList* list);
+int generateLegalMoves(Position* position, MoveList* list);
+int hasLegalReply(Position* position);
+double currentSeconds();
+void moveToCoordinates(EncodedMove move, char text[]);
+unsigned long long perft(Position* position, int depth);
+unsigned long long perftDivide(Position* position, int depth);
+int runPerft(const char fen[], int depth, int isDivide);
+int runPerftSuite(int maxDepth);
+void initPgnReader(PgnReader* reader, FILE* file);
+void initPgnMemoryReader(PgnReader* reader, const char data[], size_t length);
+int openPgnFile(PgnReader* reader, const char path[]);
+void closePgnFile(PgnReader* reader);
+int pgnPeekChar(PgnReader* reader);
+int pgnNextChar(PgnReader* reader);
+int skipPgnSeparators(PgnReader* reader);
+int pgnTokenIs(PgnToken token, const char text[]);
+int readPgnToken(PgnReader* reader, PgnToken* token);
+int pgnTagValue(PgnToken tag, const char name[], char value[], int size);
+int readPgnGame(PgnReader* reader, PgnGameVerdict* verdict);
+long validatePgnGames(PgnReader* reader, FILE* report);
+long validatePgnFile(const char path[], FILE* report);
+int processorsCount();
+void validatePgnGame(PgnReader* reader, const PgnGameInput* game, PgnGameVerdict* verdict);
+#if THREADS_SUPPORT
+int popBatchGame(BatchDeque* deque);
+int stealBatchGames(BatchDeque* victim, BatchDeque* thief);
+int runBatchWorker(void* argument);
+#endif
+long validatePgnBatch(const PgnGameInput games[], int count, PgnGameVerdict verdicts[], int threads,
+	TranspositionTable* table);
+
+#endif
@@ -0,0 +1,587 @@
+/*
+	Behavior checks of the game, which are run by "make check" after the perft suite. any check
+	prints its name with ok or FAILED, and the exit status is 1 if any check failed. it is linked
+	with chess-game.c, whose functions are declared by chess-game.h.
+*/
+#include "chess-game.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Number of the checks which were run and of the checks which failed
+int checksCount = 0;
+int failuresCount = 0;
+
+/*************************************************************************************************
+*	Function name: expect
+*	Input: int condition, const char name[]
+*	Output: None
+*	Function Operation: the function prints the name of check with ok if condition is true,
+*	otherwise with FAILED, and counts it.
+***************************************************************************************************/
+void expect(int condition, const char name[]) {
+	printf("%s %s\n", condition ? "ok" : "FAILED", name);
+	checksCount++;
+	if (!condition) {
+		failuresCount++;
+	}
+}
+
+/*************************************************************************************************
+*	Function name: readAllVerdicts
+*	Input: PgnReader* reader, PgnGameVerdict verdicts[], int size
+*	Output: int (number of games)
+*	Function Operation: the function reads the games of reader by readPgnGame(), up to size games.
+***************************************************************************************************/
+int readAllVerdicts(PgnReader* reader, PgnGameVerdict verdicts[], int size) {
+
+	int count = 0;
+
+	while (count < size && readPgnGame(reader, &verdicts[count])) {
+		count++;
+	}
+	return count;
+}
+
+/*************************************************************************************************
+*	Function name: checkFenParsing
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks the error code of parseFen() for malformed FEN in any
+*	field, the parsing of FEN view in read only text which continues after it, the default values
+*	of missing fields and the errors of bulk parsing.
+***************************************************************************************************/
+void checkFenParsing() {
+
+	const char* fens[] = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1",
+		"rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"rnbqkbnr/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkz - 0 1",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e5 0 1",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1",
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 z"
+	};
+	const int errors[] = { FEN_BAD_PIECE, FEN_BAD_ROW, FEN_BAD_ROWS_COUNT, FEN_BAD_SIDE, FEN_BAD_CASTLING,
+		FEN_BAD_EN_PASSANT, FEN_BAD_CLOCK, FEN_EXTRA_DATA };
+	const char view[] = "4k3/8/8/3pP3/8/8/8/4K3 w - d6 7 42|not FEN";
+	const char bulk[] = "8/8/8/8/8/8/8/K1k5 b - - 0 1\r\n\n8/8/8/8/8/8/8/K1k5 w - - 0\nK7/8 w\n";
+	char name[80];
+	FenFields fields, bulkFields[4];
+	int bulkErrors[4];
+
+	for (int z = 0; z < (int)(sizeof(errors) / sizeof(errors[0])); z++) {
+		snprintf(name, sizeof(name), "FEN parsing: %s", fenErrorText(errors[z]));
+		expect(parseFen(fens[z], -1, &fields) == errors[z], name);
+	}
+
+	expect(parseFen(view, (int)(strchr(view, '|') - view), &fields) == FEN_OK && fields.isWhiteTurn
+		&& fields.enPassantSquare == (SIZE - 6) * SIZE + 3 && fields.halfmoveClock == 7 && fields.fullmoveNumber == 42,
+		"FEN parsing: view of read only text");
+	expect(parseFen("4k3/8/8/8/8/8/8/4K3", -1, &fields) == FEN_OK && fields.isWhiteTurn && !fields.castlingRights
+		&& fields.enPassantSquare == -1 && fields.halfmoveClock == 0 && fields.fullmoveNumber == 1,
+		"FEN parsing: default values of missing fields");
+	expect(parseFenBulk(bulk, strlen(bulk), bulkFields, bulkErrors, 4) == 3 && bulkErrors[0] == FEN_OK
+		&& !bulkFields[0].isWhiteTurn && bulkErrors[1] == FEN_OK && bulkErrors[2] == FEN_BAD_ROWS_COUNT,
+		"FEN parsing: bulk lines with errors");
+}
+
+/*************************************************************************************************
+*	Function name: checkFenConversion
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks that FEN which is converted to position and back by
+*	positionToFen() is the same FEN, and that the placement of 2D board which is created from FEN
+*	is written back by boardToFen(), for boards with long empty runs and with full rows.
+***************************************************************************************************/
+void checkFenConversion() {
+
+	const char* fens[] = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+		"8/8/8/8/8/8/8/8 w - - 5 40",
+		"7k/8/8/8/8/8/8/K7 b - - 99 120"
+	};
+	char text[FEN_MAX_LENGTH], board[SIZE][SIZE], name[128];
+	Position position;
+
+	for (int z = 0; z < (int)(sizeof(fens) / sizeof(fens[0])); z++) {
+		int length = (int)(strchr(fens[z], ' ') - fens[z]);
+		char fen[FEN_MAX_LENGTH];
+
+		createPosition(&position, fens[z]);
+		positionToFen(&position, text);
+		snprintf(name, sizeof(name), "FEN conversion: position of %s", fens[z]);
+		expect(!strcmp(text, fens[z]), name);
+
+		strcpy(fen, fens[z]);
+		createBoard(board, fen);
+		snprintf(name, sizeof(name), "FEN conversion: board of %.*s", length, fens[z]);
+		expect(boardToFen(board, text) == length && !strncmp(text, fens[z], length), name);
+	}
+}
+
+/*************************************************************************************************
+*	Function name: playMoves
+*	Input: Position* position, const char moves[]
+*	Output: int (number of legal moves)
+*	Function Operation: the function makes the SAN moves, which are separated by spaces, on
+*	position by makePositionMove(), until the first illegal move.
+***************************************************************************************************/
+int playMoves(Position* position, const char moves[]) {
+
+	int count = 0;
+
+	while (*moves) {
+		int length = (int)strcspn(moves, " ");
+		if (!makePositionMove(position, moves, length)) {
+			return count;
+		}
+		count++;
+		moves += length;
+		moves += strspn(moves, " ");
+	}
+	return count;
+}
+
+/*************************************************************************************************
+*	Function name: isSamePosition
+*	Input: Position* position, const char fen[]
+*	Output: int (0 or 1)
+*	Function Operation: the function returns 1 if position has the pieces, the Zobrist key and the
+*	en passant square of the position of fen, otherwise 0.
+***************************************************************************************************/
+int isSamePosition(Position* position, const char fen[]) {
+
+	Position expected;
+
+	createPosition(&expected, fen);
+	return position->key == expected.key && position->enPassantSquare == expected.enPassantSquare
+		&& !memcmp(position->mailbox, expected.mailbox, sizeof(expected.mailbox));
+}
+
+/*************************************************************************************************
+*	Function name: checkEnPassant
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks en passant capture right after the two steps of the
+*	Pawn and not later, the capture which exposes the King on its row, and the Zobrist key, which
+*	includes the en passant square only when the capture is possible.
+***************************************************************************************************/
+void checkEnPassant() {
+
+	Position position;
+
+	createPosition(&position, "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+	expect(playMoves(&position, "exf6") == 1
+		&& isSamePosition(&position, "rnbqkbnr/ppp1p1pp/5P2/3p4/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 3"),
+		"en passant: capture removes the Pawn which passed");
+	createPosition(&position, "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+	expect(playMoves(&position, "exd6") == 0, "en passant: only the Pawn of the last move");
+
+	createPosition(&position, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+	expect(playMoves(&position, "e4 a6 e5 d5 exd6") == 5, "en passant: square is carried between moves");
+	createPosition(&position, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+	expect(playMoves(&position, "e4 a6 e5 d5 Nf3 Nf6 exd6") == 6, "en passant: square expires after one move");
+
+	createPosition(&position, "8/8/8/KPp4r/8/8/8/7k w - c6 0 1");
+	expect(playMoves(&position, "bxc6") == 0, "en passant: capture which exposes the King on its row");
+
+	createPosition(&position, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+	playMoves(&position, "e4");
+	expect(isSamePosition(&position, "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"),
+		"en passant: square without capture is not in the key");
+	playMoves(&position, "Nf6 e5 d5");
+	expect(isSamePosition(&position, "rnbqkb1r/ppp1pppp/5n2/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3"),
+		"en passant: square with capture is in the key");
+}
+
+/*************************************************************************************************
+*	Function name: checkPgnReading
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks the verdicts of PGN games which are parsed in place in
+*	memory, where the data is not NUL terminated and is followed by other chars, and that the same
+*	PGN from file (memory mapped where it is possible) gets the same verdicts.
+***************************************************************************************************/
+void checkPgnReading() {
+
+	const char pgn[] = "[Event \"mate\"]\n[Result \"1-0\"]\n\n1. e4 e5 2. Bc4 Nc6 3. Qh5 Nf6 4. Qxf7# 1-0\n\n"
+		"[Event \"illegal\"]\n\n1. d4 d5 2. Nf3 Ke6 0-1\n\n[Event \"unfinished\"]\n\n1. e4 e5 2. Qh5";
+	const char path[] = "checks.pgn";
+	size_t length = strlen(pgn);
+	char* data = malloc(length + 2);
+	PgnReader* reader = malloc(sizeof(PgnReader));
+	PgnGameVerdict memoryVerdicts[4], fileVerdicts[4];
+	FILE* file = fopen(path, "wb");
+
+	if (data == NULL || reader == NULL || file == NULL) {
+		expect(0, "PGN reading: allocation");
+		free(reader);
+		free(data);
+		if (file != NULL) {
+			fclose(file);
+		}
+		return;
+	}
+
+	// The chars after the data would make the last move illegal if they were read
+	memcpy(data, pgn, length);
+	memcpy(data + length, "xx", 2);
+	initPgnMemoryReader(reader, data, length);
+	int count = readAllVerdicts(reader, memoryVerdicts, 4);
+	expect(count == 3, "PGN reading: games are separated by tags");
+	expect(memoryVerdicts[0].plies == 7 && !memoryVerdicts[0].illegalPly && !strcmp(memoryVerdicts[0].result, "1-0"),
+		"PGN reading: legal game with mate and result");
+	expect(memoryVerdicts[1].illegalPly == 4 && memoryVerdicts[1].illegalLine == 8
+		&& !strcmp(memoryVerdicts[1].illegalMove, "Ke6"), "PGN reading: ply, line and text of illegal move");
+	expect(memoryVerdicts[2].plies == 3 && !memoryVerdicts[2].illegalPly && memoryVerdicts[2].result[0] == '\0',
+		"PGN reading: nothing is read after the length of data");
+
+	fwrite(pgn, 1, length, file);
+	fclose(file);
+	int isSame = openPgnFile(reader, path) && readAllVerdicts(reader, fileVerdicts, 4) == count;
+	for (int z = 0; isSame && z < count; z++) {
+		isSame = fileVerdicts[z].plies == memoryVerdicts[z].plies && fileVerdicts[z].illegalPly == memoryVerdicts[z].illegalPly
+			&& fileVerdicts[z].illegalLine == memoryVerdicts[z].illegalLine
+			&& !strcmp(fileVerdicts[z].illegalMove, memoryVerdicts[z].illegalMove)
+			&& !strcmp(fileVerdicts[z].result, memoryVerdicts[z].result);
+	}
+	closePgnFile(reader);
+	remove(path);
+	expect(isSame, "PGN reading: file gets the verdicts of memory");
+
+	free(reader);
+	free(data);
+}
+
+/*************************************************************************************************
+*	Function name: checkTranspositionTable
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks the hits and misses of the transposition table when
+*	the same move is validated again on the same position, the cached illegal move, and that entry
+*	of other position or of wrong move is never played.
+***************************************************************************************************/
+void checkTranspositionTable() {
+
+	TranspositionTable table;
+	Position position, expected;
+	EncodedMove move;
+
+	if (!initTranspositionTable(&table, (size_t)1 << 20)) {
+		expect(0, "transposition table: allocation");
+		return;
+	}
+
+	// First move text is miss, again the legality and the cached legal moves are hits
+	createPosition(&position, INITIAL_FEN);
+	expect(makeCachedMove(&table, &position, "e4", 2) && table.hits == 0 && table.misses == 1,
+		"transposition table: new move is miss");
+	createPosition(&position, INITIAL_FEN);
+	expect(makeCachedMove(&table, &position, "e4", 2) && table.hits == 1 && table.misses == 2,
+		"transposition table: repeated move is hit, its legal moves are generated once");
+	createPosition(&position, INITIAL_FEN);
+	expect(makeCachedMove(&table, &position, "e4", 2) && table.hits == 3 && table.misses == 2,
+		"transposition table: repeated move and its legal moves are hits");
+	createPosition(&expected, "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+	expect(position.key == expected.key, "transposition table: cached move is made");
+
+	createPosition(&position, INITIAL_FEN);
+	expect(!makeCachedMove(&table, &position, "e5", 2) && !makeCachedMove(&table, &position, "e5", 2)
+		&& table.hits == 4 && table.misses == 3, "transposition table: illegal move is cached");
+
+	// Same lookup key of other position doesn't match the position half of the entry
+	HashKey textHash = moveTextHash("e4", 2);
+	HashKey otherKey = position.key ^ (1ULL << 40);
+	expect(probeMoveLegality(&table, otherKey, textHash ^ (1ULL << 40), &move) < 0,
+		"transposition table: other position with the same lookup key is miss");
+
+	// Wrong move in the entry of the position is validated again instead of being played
+	storeMoveLegality(&table, position.key, moveTextHash("Nf3", 3), encodeMove(1, 18, -1), 1);
+	expect(makeCachedMove(&table, &position, "Nf3", 3), "transposition table: wrong cached move is validated again");
+	createPosition(&expected, "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1");
+	expect(position.key == expected.key && !memcmp(position.mailbox, expected.mailbox, sizeof(position.mailbox)),
+		"transposition table: the validated move is made");
+
+	freeTranspositionTable(&table);
+}
+
+/*************************************************************************************************
+*	Function name: checkStalemate
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks that move which leaves the opponent without legal move
+*	and not in check is found as stalemate, also when it is taken from the transposition table,
+*	and that the verdict of PGN game which ends by it records the stalemate.
+***************************************************************************************************/
+void checkStalemate() {
+
+	const char fen[] = "7k/8/6K1/8/8/8/8/5Q2 w - - 0 1";
+	const char pgn[] = "[FEN \"7k/8/6K1/8/8/8/8/5Q2 w - - 0 1\"]\n\n1. Qf7 1/2-1/2\n";
+	TranspositionTable table;
+	Position position;
+	PgnGameVerdict verdict;
+	PgnReader* reader = malloc(sizeof(PgnReader));
+
+	createPosition(&position, fen);
+	expect(makePositionMove(&position, "Qf7", 3) == MOVE_STALEMATE, "stalemate: found by the trial of move");
+	createPosition(&position, fen);
+	expect(makePositionMove(&position, "Qf8#", 4) == MOVE_LEGAL, "stalemate: mate is not stalemate");
+	createPosition(&position, fen);
+	expect(makePositionMove(&position, "Qf5", 3) == MOVE_LEGAL, "stalemate: opponent with legal move");
+
+	if (initTranspositionTable(&table, (size_t)1 << 20)) {
+		createPosition(&position, fen);
+		int result = makeCachedMove(&table, &position, "Qf7", 3);
+		createPosition(&position, fen);
+		expect(result == MOVE_STALEMATE && makeCachedMove(&table, &position, "Qf7", 3) == MOVE_STALEMATE
+			&& table.hits > 0, "stalemate: kept in the transposition table");
+		freeTranspositionTable(&table);
+	}
+
+	if (reader != NULL) {
+		initPgnMemoryReader(reader, pgn, strlen(pgn));
+		expect(readPgnGame(reader, &verdict) && verdict.plies == 1 && verdict.isStalemate,
+			"stalemate: recorded in the verdict of PGN game");
+		free(reader);
+	}
+}
+
+/*************************************************************************************************
+*	Function name: checkDrawClaims
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks draw claims of game state: threefold repetition after
+*	Knights shuffle, which is not claimable after the second occurrence, fifty-move rule after the
+*	100th ply without capture or Pawn move, and the draw ply of PGN game verdict.
+***************************************************************************************************/
+void checkDrawClaims() {
+
+	const char* shuffle[] = { "Nf3", "Nf6", "Ng1", "Ng8", "Nf3", "Nf6", "Ng1", "Ng8" };
+	const char fiftyMovesFen[] = "4k3/8/8/8/8/8/4P3/4K2R w - - 99 80";
+	const char pgn[] = "[Event \"shuffle\"]\n\n1. Nf3 Nf6 2. Ng1 Ng8 3. Nf3 Nf6 4. Ng1 Ng8 5. e4 1/2-1/2\n";
+	GameState game;
+	PgnGameVerdict verdict;
+	PgnReader* reader = malloc(sizeof(PgnReader));
+	int claims = 0;
+
+	createGameState(&game, INITIAL_FEN);
+	for (int z = 0; z < 8; z++) {
+		playGameMove(&game, NULL, shuffle[z], (int)strlen(shuffle[z]));
+		claims += canClaimDraw(&game);
+	}
+	expect(repetitionCount(&game) == 3 && isThreefoldRepetition(&game) && claims == 1,
+		"draw claims: threefold repetition only on the third occurrence");
+
+	createGameState(&game, fiftyMovesFen);
+	expect(!canClaimDraw(&game), "draw claims: 99 plies are not enough");
+	playGameMove(&game, NULL, "Rh2", 3);
+	expect(isFiftyMoveRule(&game) && canClaimDraw(&game), "draw claims: fifty-move rule after 100 plies");
+	createGameState(&game, fiftyMovesFen);
+	playGameMove(&game, NULL, "e4", 2);
+	expect(!canClaimDraw(&game), "draw claims: Pawn move resets the fifty-move clock");
+
+	if (reader != NULL) {
+		initPgnMemoryReader(reader, pgn, strlen(pgn));
+		expect(readPgnGame(reader, &verdict) && verdict.plies == 9 && verdict.drawPly == 8,
+			"draw claims: first claimable ply in the verdict of PGN game");
+		free(reader);
+	}
+}
+
+/*************************************************************************************************
+*	Function name: checkSanParsing
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks the error code of parseSan() for any kind of malformed
+*	SAN, and the fields of valid SAN with source column, capture, promotion, check and mate.
+***************************************************************************************************/
+void checkSanParsing() {
+
+	const char* texts[] = { "", "Xe4", "Ni9", "e4x", "e8=K", "O-O-O-O", "e4+!", "e8Q" };
+	const int errors[] = { SAN_EMPTY, SAN_BAD_PIECE, SAN_BAD_SQUARE, SAN_BAD_CAPTURE, SAN_BAD_PROMOTION,
+		SAN_BAD_CASTLING, SAN_EXTRA_DATA, SAN_EXTRA_DATA };
+	char name[64];
+	Move move;
+
+	initChessGame();
+	for (int z = 0; z < (int)(sizeof(errors) / sizeof(errors[0])); z++) {
+		move.isWhite = 1;
+		snprintf(name, sizeof(name), "SAN parsing: \"%s\" is %s", texts[z], sanErrorText(errors[z]));
+		expect(parseSan(texts[z], (int)strlen(texts[z]), &move) == errors[z], name);
+	}
+
+	move.isWhite = 1;
+	expect(parseSan("Nbxd7+", 6, &move) == SAN_OK && move.srcPiece == 'N' && move.iSrc == -1 && move.jSrc == 1
+		&& move.iDest == SIZE - 7 && move.jDest == 3 && move.isCapture && move.isCheck && !move.isMate,
+		"SAN parsing: source column, capture and check");
+	expect(parseSan("exd8=Q#", 7, &move) == SAN_OK && move.srcPiece == 'P' && move.jSrc == 4
+		&& move.iDest == SIZE - 8 && move.isPromotion && move.promotionPiece == 'Q' && move.isMate,
+		"SAN parsing: promotion and mate");
+	expect(parseSan("0-0-0", 5, &move) == SAN_OK && move.castling == 1, "SAN parsing: castling with zeros");
+}
+
+/*************************************************************************************************
+*	Function name: checkSearch
+*	Input: None
+*	Output: None
+*	Function Operation: the function checks that the search finds mate in one move for any side,
+*	scored as mate in one ply, also with search table and several threads, and that position
+*	without legal move has no best move.
+***************************************************************************************************/
+void checkSearch() {
+
+	SearchLimits limits = { 4, 0, 0 };
+	SearchTable table;
+	SearchResult result;
+	Position position;
+
+	createPosition(&position, "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+	expect(searchPosition(&position, &limits, NULL, 1, &result) && result.bestMove == encodeMove(SQUARES - SIZE, 0, -1)
+		&& result.score == MATE_SCORE - 1, "search: mate in one of white");
+	createPosition(&position, "r5k1/8/8/8/8/8/5PPP/6K1 b - - 0 1");
+	expect(searchPosition(&position, &limits, NULL, 1, &result) && result.bestMove == encodeMove(0, SQUARES - SIZE, -1)
+		&& result.score == MATE_SCORE - 1, "search: mate in one of black");
+
+	if (initSearchTable(&table, (size_t)1 << 20)) {
+		createPosition(&position, "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+		expect(searchPosition(&position, &limits, &table, 2, &result) && result.bestMove == encodeMove(SQUARES - SIZE, 0, -1),
+			"search: mate in one with search table and two threads");
+		freeSearchTable(&table);
+	}
+
+	createPosition(&position, "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+	expect(!searchPosition(&position, &limits, NULL, 1, &result) && result.bestMove == 0 && result.score == 0,
+		"search: stalemate has no best move");
+}
+
+
+/*************************************************************************************************
+*	Function name: writeNnueNetwork
+*	Input: const char path[]
+*	Output: int (0 or 1)
+*	Function Operation: the function writes network file of pseudo random values (of fixed seed)
+*	in the format of loadNnueNetwork(). 1 return if the file was written, otherwise 0.
+***************************************************************************************************/
+int writeNnueNetwork(const char path[]) {
+
+	size_t valuesCount = (size_t)NNUE_FEATURES * NNUE_HIDDEN + NNUE_HIDDEN + COLORS * NNUE_HIDDEN;
+	unsigned int seed = 1;
+	int header[2] = { NNUE_FEATURES, NNUE_HIDDEN };
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		return 0;
+	}
+	fputs(NNUE_MAGIC, file);
+	for (int z = 0; z < 2; z++) {
+		for (int byte = 0; byte < 4; byte++) {
+			fputc(header[z] >> 8 * byte & 0xFF, file);
+		}
+	}
+	// Small values keep the hidden layer inside the clipping range for most positions
+	for (size_t z = 0; z < valuesCount; z++) {
+		seed = seed * 1103515245 + 12345;
+		int value = (int)(seed >> 16 & 0x7F) - 48;
+		fputc(value & 0xFF, file);
+		fputc(value >> 8 & 0xFF, file);
+	}
+	for (int byte = 0; byte < 4; byte++) {
+		fputc(byte ? 0 : 100, file);
+	}
+	return fclose(file) == 0;
+}
+
+/*************************************************************************************************
+*	Function name: walkNnueMoves
+*	Input: Position* position, int depth
+*	Output: int (number of positions which don't match)
+*	Function Operation: the function makes and unmakes all the legal moves of position until depth,
+*	and compares the incremental accumulator and score of any position with refreshed ones, and
+*	the accumulator after undoMove() with the one before the move.
+***************************************************************************************************/
+int walkNnueMoves(Position* position, int depth) {
+
+	Position refreshed = *position;
+	MoveList list;
+	int mismatches = 0;
+
+	refreshNnueAccumulator(&refreshed);
+	if (memcmp(refreshed.accumulator, position->accumulator, sizeof(position->accumulator)) != 0
+		|| evaluateNnue(&refreshed) != evaluateNnue(position)) {
+		mismatches++;
+	}
+	if (depth == 0) {
+		return mismatches;
+	}
+
+	generateLegalMoves(position, &list);
+	for (int z = 0; z < list.count; z++) {
+		UndoInfo undo;
+		doMove(position, list.moves[z], &undo);
+		mismatches += walkNnueMoves(position, depth - 1);
+		undoMove(position, &undo);
+		if (memcmp(refreshed.accumulator, position->accumulator, sizeof(position->accumulator)) != 0) {
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+/*************************************************************************************************
+*	Function name: checkNnueAccumulator
+*	Input: None
+*	Output: None
+*	Function Operation: the function loads network of pseudo random values, and checks that the
+*	accumulator which is updated by doMove() and undoMove() matches refreshed accumulator, after
+*	captures, castling, en passant and promotions.
+***************************************************************************************************/
+void checkNnueAccumulator() {
+
+	const char path[] = "checks-network.bin";
+	Position position;
+
+	expect(!loadNnueNetwork("checks-missing-network.bin"), "nnue: missing network file is rejected");
+	int isLoaded = writeNnueNetwork(path) && loadNnueNetwork(path);
+	expect(isLoaded, "nnue: network file is loaded");
+	if (!isLoaded) {
+		remove(path);
+		return;
+	}
+
+	createPosition(&position, INITIAL_FEN);
+	expect(walkNnueMoves(&position, 3) == 0, "nnue: incremental accumulator of initial position");
+	createPosition(&position, "r3k2r/1P1pqpb1/bn2pnp1/2pPN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq c6 0 1");
+	expect(walkNnueMoves(&position, 2) == 0, "nnue: incremental accumulator with castling, en passant and promotion");
+
+	freeNnueNetwork();
+	remove(path);
+}
+/*************************************************************************************************
+*	Function name: main
+*	Input: None
+*	Output: int (0 if all the checks passed)
+*	Function Operation: the function runs all the checks and prints the number of failures.
+***************************************************************************************************/
+int main() {
+
+	checkFenParsing();
+	checkFenConversion();
+	checkPgnReading();
+	checkTranspositionTable();
+	checkStalemate();
+	checkDrawClaims();
+	checkEnPassant();
+	checkSanParsing();
+	checkSearch();
+	checkNnueAccumulator();
+
+	printf("Total: %d checks, %d failed\n", checksCount, failuresCount);
+	return failuresCount > 0;
+}
@@ -0,0 +1,123 @@
+/*
+	Command line driver of the perft tool and the regression gate. it is linked with chess-game.c,
+	whose functions are declared by chess-game.h (included first, as it sets the POSIX macro).
+*/
+#include "chess-game.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Depth of the suite when no depth is given: all the references
+#define SUITE_DEPTH 7
+
+// Iterations of benchmark when no number is given, and search table size of search benchmark
+#define BENCH_ITERATIONS 1000000
+#define BENCH_TABLE_BYTES ((size_t)64 << 20)
+
+/*************************************************************************************************
+*	Function name: printUsage
+*	Input: const char program[]
+*	Output: None
+*	Function Operation: the function prints the commands of the tool.
+***************************************************************************************************/
+void printUsage(const char program[]) {
+	fprintf(stderr, "usage:\n");
+	fprintf(stderr, "  %s <fen> <depth> [--divide]\n", program);
+	fprintf(stderr, "  %s --suite [max depth]\n", program);
+	fprintf(stderr, "  %s bench fen <fen> [iterations]\n", program);
+	fprintf(stderr, "  %s bench san \"<san> <san> ...\" [iterations]\n", program);
+	fprintf(stderr, "  %s bench search <fen> <depth> [max threads]\n", program);
+	fprintf(stderr, "  %s bench nnue <weights> <fen> [iterations]\n", program);
+}
+
+/*************************************************************************************************
+*	Function name: runSanBenchmark
+*	Input: char moves[], int iterations
+*	Output: int (0 or 1)
+*	Function Operation: the function splits moves, which are separated by spaces, in place and
+*	parses them iterations times by benchmarkSanParsing(). 0 return if there is no move.
+***************************************************************************************************/
+int runSanBenchmark(char moves[], int iterations) {
+
+	const char** list = malloc(sizeof(char*) * (strlen(moves) / 2 + 1));
+	int count = 0;
+
+	if (list == NULL) {
+		return 0;
+	}
+	for (char* move = strtok(moves, " "); move != NULL; move = strtok(NULL, " ")) {
+		list[count++] = move;
+	}
+	if (count > 0) {
+		benchmarkSanParsing(list, count, iterations);
+	}
+	free(list);
+	return count > 0;
+}
+
+/*************************************************************************************************
+*	Function name: runBenchmark
+*	Input: int argc, char* argv[]
+*	Output: int (0 on success)
+*	Function Operation: the function runs the benchmark which is named after "bench" in the
+*	arguments, with its own arguments. the search benchmark runs up to the number of processors if
+*	max threads is not given, and the neural evaluation benchmark loads the network of weights
+*	file first. 2 return if the arguments are wrong, and 1 if the benchmark failed.
+***************************************************************************************************/
+int runBenchmark(int argc, char* argv[]) {
+
+	if (argc >= 4 && argc <= 5 && strcmp(argv[2], "fen") == 0) {
+		benchmarkFenConversion(argv[3], argc == 5 ? atoi(argv[4]) : BENCH_ITERATIONS);
+		return 0;
+	}
+	if (argc >= 4 && argc <= 5 && strcmp(argv[2], "san") == 0) {
+		return !runSanBenchmark(argv[3], argc == 5 ? atoi(argv[4]) : BENCH_ITERATIONS);
+	}
+	if (argc >= 5 && argc <= 6 && strcmp(argv[2], "search") == 0 && atoi(argv[4]) >= 1) {
+		return !benchmarkParallelSearch(argv[3], atoi(argv[4]), argc == 6 ? atoi(argv[5]) : 0, BENCH_TABLE_BYTES);
+	}
+	if (argc >= 5 && argc <= 6 && strcmp(argv[2], "nnue") == 0) {
+		if (!loadNnueNetwork(argv[3])) {
+			fprintf(stderr, "can't load network: %s\n", argv[3]);
+			return 1;
+		}
+		int isDone = benchmarkNnueEvaluation(argv[4], argc == 6 ? atoi(argv[5]) : BENCH_ITERATIONS);
+		freeNnueNetwork();
+		return !isDone;
+	}
+
+	printUsage(argv[0]);
+	return 2;
+}
+
+/*************************************************************************************************
+*	Function name: main
+*	Input: int argc, char* argv[]
+*	Output: int (0 on success)
+*	Function Operation: with --suite, the reference positions are run up to the max depth and the
+*	exit status is 1 if any of them failed, so the suite can be used as regression gate. otherwise
+*	perft runs on the fen to depth, or divides the nodes of depth by the moves with --divide.
+*	"bench" runs one of the benchmarks by runBenchmark().
+***************************************************************************************************/
+int main(int argc, char* argv[]) {
+
+	if (argc >= 2 && strcmp(argv[1], "--suite") == 0) {
+		return runPerftSuite(argc >= 3 ? atoi(argv[2]) : SUITE_DEPTH) > 0;
+	}
+	if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+		return runBenchmark(argc, argv);
+	}
+
+	if (argc < 3 || (argc == 4 && strcmp(argv[3], "--divide") != 0) || argc > 4 || atoi(argv[2]) < 1) {
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	int error = runPerft(argv[1], atoi(argv[2]), argc == 4);
+	if (error) {
+		fprintf(stderr, "bad fen: %s\n", fenErrorText(error));
+		return 2;
+	}
+	return 0;
+}